@@ -0,0 +1,121 @@
+// Perft benchmark and validation for the bitboard Board.
+//
+// Usage: perft_bench [max-depth] ["fen" depth]
+//
+// Counts the leaf nodes of the legal move tree for the standard perft test
+// positions and compares them with the published counts; with a FEN and a
+// depth only that position is counted. Zobrist keys are checked against a
+// full recomputation along the tree at low depth.
+
+#include "Board.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    uint64_t counts[6];  // Depth 1..6, 0 = not listed
+};
+
+static const PerftCase cases[] = {
+    { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      { 20, 400, 8902, 197281, 4865609, 119060324 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      { 48, 2039, 97862, 4085603, 193690690, 0 } },
+    { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      { 14, 191, 2812, 43238, 674624, 11030083 } },
+    { "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      { 6, 264, 9467, 422333, 15833292, 0 } },
+    { "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      { 44, 1486, 62379, 2103487, 89941194, 0 } },
+    { "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      { 46, 2079, 89890, 3894594, 164075551, 0 } },
+};
+
+// Walk the tree and compare the incremental key with a full recomputation
+static bool verifyHash(Board& board, int depth) {
+    if (board.getHash() != board.computeHash()) {
+        std::cerr << "Hash mismatch at " << board.toFen() << std::endl;
+        return false;
+    }
+    if (depth == 0) {
+        return true;
+    }
+
+    std::vector<Move> moves;
+    board.generateLegalMoves(moves);
+    uint64_t before = board.getHash();
+    for (size_t i = 0; i < moves.size(); i++) {
+        board.makeMove(moves[i]);
+        bool ok = verifyHash(board, depth - 1);
+        board.unmakeMove();
+        if (!ok || board.getHash() != before) {
+            if (ok) {
+                std::cerr << "Hash not restored after " << moves[i].toUci() << " at " << board.toFen() << std::endl;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+static double runPerft(Board& board, int depth, uint64_t& nodes) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nodes = board.perft(depth);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3) {
+        Board board;
+        board.setFromFen(argv[1]);
+        uint64_t nodes;
+        double seconds = runPerft(board, atoi(argv[2]), nodes);
+        printf("perft(%d) = %llu  (%.3f s, %.1f Mnodes/s)\n", atoi(argv[2]), (unsigned long long)nodes,
+               seconds, nodes / seconds / 1e6);
+        return 0;
+    }
+
+    int maxDepth = (argc >= 2) ? atoi(argv[1]) : 5;
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        Board board;
+        board.setFromFen(cases[c].fen);
+
+        if (!verifyHash(board, 3)) {
+            allPassed = false;
+        }
+
+        for (int depth = 1; depth <= maxDepth && depth <= 6; depth++) {
+            uint64_t expected = cases[c].counts[depth - 1];
+            if (expected == 0) {
+                break;
+            }
+
+            uint64_t nodes;
+            double seconds = runPerft(board, depth, nodes);
+            totalNodes += nodes;
+            totalSeconds += seconds;
+
+            bool ok = (nodes == expected);
+            allPassed = allPassed && ok;
+            printf("%-10s depth %d: %12llu  %s  (%.3f s)\n", cases[c].name, depth, (unsigned long long)nodes,
+                   ok ? "ok" : "MISMATCH", seconds);
+            if (!ok) {
+                printf("           expected %llu\n", (unsigned long long)expected);
+            }
+        }
+    }
+
+    printf("\n%llu nodes in %.2f s (%.1f Mnodes/s)\n", (unsigned long long)totalNodes, totalSeconds,
+           totalSeconds > 0 ? totalNodes / totalSeconds / 1e6 : 0.0);
+    printf("%s\n", allPassed ? "All perft counts match" : "PERFT FAILED");
+    return allPassed ? 0 : 1;
+}
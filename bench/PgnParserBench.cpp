@@ -0,0 +1,184 @@
+// Throughput benchmark for the PGN parser and its delimiter scanning.
+//
+// Usage: pgn_parser_bench [games.pgn] [passes]
+//
+// Parses the file the given number of times with each input path (stream
+// input through std::getline, memory-mapped input at every byte scanning
+// level the CPU supports, and chunked on all cores) and reports MB/s, games/s
+// and moves/s. A raw line splitting pass over the mapping shows the cost of
+// the scanning alone. Chunked parsing only kicks in above 4 MB. The last row
+// keeps every game in memory and reports the heap bytes retained per game.
+// Without a file, a database of 20000 copies of a commented game is
+// written to a temporary file. For a multi-GB run, replicate a real file:
+//
+//   for i in $(seq 30000); do cat dreier.pgn; done > big.pgn
+//   ./pgn_parser_bench big.pgn 1
+
+#include "PgnParser.h"
+#include "ByteScan.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static std::string synthesizeDatabase() {
+    static const char* game =
+        "[Event \"Paris\"]\n"
+        "[Site \"Paris FRA\"]\n"
+        "[Date \"1858.??.??\"]\n"
+        "[Round \"?\"]\n"
+        "[White \"Paul Morphy\"]\n"
+        "[Black \"Duke Karl / Count Isouard\"]\n"
+        "[Result \"1-0\"]\n"
+        "\n"
+        "1. e4 e5 2. Nf3 d6 3. d4 Bg4 {This is a weak move already.} 4. dxe5 Bxf3\n"
+        "5. Qxf3 dxe5 6. Bc4 Nf6 7. Qb3 Qe7 8. Nc3 c6 9. Bg5 b5?! (9... Qb4+ 10. Qxb4\n"
+        "Bxb4) 10. Nxb5 $1 cxb5 11. Bxb5+ Nbd7 12. O-O-O Rd8 13. Rxd7 Rxd7 14. Rd1 Qe6\n"
+        "15. Bxd7+ Nxd7 16. Qb8+ Nxb8 17. Rd8# 1-0\n"
+        "\n";
+
+    std::string database;
+    for (int i = 0; i < 20000; i++) {
+        database += game;
+    }
+    return database;
+}
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* label, double mb, double seconds, size_t games, size_t moves) {
+    printf("%-16s %.3f s per pass: %7.1f MB/s, %8.0f games/s, %9.0f moves/s\n", label, seconds,
+           mb / seconds, games / seconds, moves / seconds);
+}
+
+// Parse the file once per pass; mapped selects memory-mapped input
+static void runParser(const char* label, const std::string& path, bool mapped, int threads, int passes, double mb) {
+    size_t games = 0;
+    size_t moves = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        PgnParser parser;
+        parser.setThreads(threads);
+        parser.setWarnings(false);
+        std::ifstream file;
+        if (mapped) {
+            parser.open(path);
+        } else {
+            file.open(path.c_str(), std::ios::binary);
+            parser.attach(file);
+        }
+
+        games = 0;
+        moves = 0;
+        Game game;
+        while (parser.nextGame(game)) {
+            games++;
+            moves += game.moves.size();
+        }
+    }
+    report(label, mb, elapsed(start) / passes, games, moves);
+}
+
+// Heap bytes held by all games of the file (moves, headers and the shared
+// header pool), per game
+static void runRetained(const std::string& path) {
+    size_t before = mallinfo2().uordblks;
+    std::vector<Game> games;
+    {
+        PgnParser parser;
+        parser.setWarnings(false);
+        parser.open(path);
+        Game game;
+        while (parser.nextGame(game)) {
+            games.push_back(game);
+        }
+    }
+    games.shrink_to_fit();
+    size_t retained = mallinfo2().uordblks - before;
+    printf("%-16s %zu games: %.0f bytes per game (%.1f MB)\n", "retained", games.size(),
+           games.empty() ? 0.0 : static_cast<double>(retained) / games.size(), retained / 1048576.0);
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    bool temporary = false;
+    if (argc >= 2) {
+        path = argv[1];
+    } else {
+        char name[] = "/tmp/pgn_parser_bench_XXXXXX";
+        int fd = mkstemp(name);
+        if (fd < 0) {
+            std::cerr << "Cannot create temporary file" << std::endl;
+            return 1;
+        }
+        std::string database = synthesizeDatabase();
+        if (write(fd, database.data(), database.size()) != static_cast<ssize_t>(database.size())) {
+            std::cerr << "Cannot write temporary file" << std::endl;
+            return 1;
+        }
+        close(fd);
+        path = name;
+        temporary = true;
+    }
+    int passes = (argc >= 3) ? atoi(argv[2]) : 3;
+
+    MappedFile mapping;
+    if (!mapping.open(path)) {
+        std::cerr << "Cannot map " << path << std::endl;
+        return 1;
+    }
+    double mb = mapping.getSize() / 1048576.0;
+    printf("%s: %.1f MB\n", temporary ? "synthesized database" : path.c_str(), mb);
+
+    ByteScan::Level best = ByteScan::getLevel();
+    const ByteScan::Level levels[] = { ByteScan::SCALAR, ByteScan::SSE2, ByteScan::AVX2 };
+
+    // Line splitting alone
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (!ByteScan::setLevel(levels[i])) {
+            continue;
+        }
+        size_t lines = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            lines = 0;
+            for (const char* p = mapping.begin(); p < mapping.end(); lines++) {
+                p = ByteScan::find(p, mapping.end(), '\n') + 1;
+            }
+        }
+        double seconds = elapsed(start) / passes;
+        std::string label = std::string("lines ") + ByteScan::levelName(levels[i]);
+        printf("%-16s %.3f s per pass: %7.1f MB/s, %zu lines\n", label.c_str(), seconds, mb / seconds, lines);
+    }
+
+    // Full parse
+    ByteScan::setLevel(best);
+    runParser("stream", path, false, 1, passes, mb);
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (!ByteScan::setLevel(levels[i])) {
+            continue;
+        }
+        std::string label = std::string("mmap ") + ByteScan::levelName(levels[i]);
+        runParser(label.c_str(), path, true, 1, passes, mb);
+    }
+    ByteScan::setLevel(best);
+
+    int threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    std::string label = "mmap " + std::to_string(threads) + " threads";
+    runParser(label.c_str(), path, true, threads, passes, mb);
+    runRetained(path);
+
+    if (temporary) {
+        unlink(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Micro-benchmark for the UCI info-line tokenizer.
+//
+// Usage: uci_info_bench [recorded-output] [passes]
+//
+// recorded-output is raw Stockfish output or a stockfish_debug.log written
+// with --debug (only "<<< RECV:" lines are used). Without a file, MultiPV 200
+// output for depths 1-25 is synthesized. The lines are fed through the
+// tokenizer and through the previous find()/istringstream parser.
+
+#include "UciInfo.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> loadLines(const char* filename) {
+    std::vector<std::string> lines;
+    std::ifstream file(filename);
+    std::string line;
+    const std::string recvPrefix = "<<< RECV: ";
+
+    while (std::getline(file, line)) {
+        if (line.compare(0, recvPrefix.size(), recvPrefix) == 0) {
+            line = line.substr(recvPrefix.size());
+        } else if (line.compare(0, 3, "<<<") == 0 || line.compare(0, 3, ">>>") == 0 || line.compare(0, 4, "    ") == 0) {
+            continue;
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static std::vector<std::string> synthesizeLines() {
+    static const char* moves[] = { "e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6", "e1g1", "f8e7" };
+    std::vector<std::string> lines;
+
+    for (int depth = 1; depth <= 25; depth++) {
+        for (int pv = 1; pv <= 200; pv++) {
+            std::ostringstream line;
+            line << "info depth " << depth << " seldepth " << depth + 6 << " multipv " << pv
+                 << " score cp " << (40 - pv * 3) << " nodes " << depth * 123456 << " nps 1523000"
+                 << " hashfull 312 tbhits 0 time " << depth * 81 << " pv";
+            for (int i = 0; i < 12; i++) {
+                line << " " << moves[(pv + i) % 10];
+            }
+            lines.push_back(line.str());
+        }
+    }
+    lines.push_back("bestmove e2e4 ponder e7e5");
+    return lines;
+}
+
+// The parser used before the tokenizer (one find() and istringstream per field)
+static bool legacyParse(const std::string& line, int& depth, int& multiPV, int& score, std::string& move) {
+    if (line.find("info ") != 0) {
+        return false;
+    }
+    size_t multiPVPos = line.find(" multipv ");
+    if (multiPVPos == std::string::npos) {
+        return false;
+    }
+    size_t depthPos = line.find(" depth ");
+    if (depthPos != std::string::npos) {
+        std::istringstream iss(line.substr(depthPos + 7));
+        iss >> depth;
+    }
+    std::istringstream issMultiPV(line.substr(multiPVPos + 9));
+    issMultiPV >> multiPV;
+    size_t cpPos = line.find(" cp ");
+    if (cpPos != std::string::npos) {
+        std::istringstream iss(line.substr(cpPos + 4));
+        iss >> score;
+    }
+    size_t pvPos = line.find(" pv ");
+    if (pvPos != std::string::npos) {
+        std::istringstream iss(line.substr(pvPos + 4));
+        iss >> move;
+    }
+    return true;
+}
+
+static void report(const char* name, double seconds, size_t lines, size_t bytes, long checksum) {
+    printf("%-22s %8.1f ms  %10.0f lines/s  %8.1f MB/s  (checksum %ld)\n", name, seconds * 1000.0,
+           lines / seconds, bytes / seconds / 1048576.0, checksum);
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> lines = (argc > 1) ? loadLines(argv[1]) : synthesizeLines();
+    int passes = (argc > 2) ? atoi(argv[2]) : 20;
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        bytes += lines[i].size() + 1;
+    }
+    printf("%zu lines, %.1f KB per pass, %d passes\n", lines.size(), bytes / 1024.0, passes);
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Tokenizer, all fields
+    long checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        UciInfo info;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (parseInfoLine(StringView(lines[i]), info) && info.multiPV > 0) {
+                checksum += info.depth + info.multiPV + info.scoreCP + (long)info.pvMove.size;
+            }
+        }
+    }
+    report("tokenizer", std::chrono::duration<double>(Clock::now() - start).count(),
+           lines.size() * passes, bytes * passes, checksum);
+
+    // Tokenizer, final depth only (other depths stop after the depth token)
+    int finalDepth = 0;
+    {
+        UciInfo info;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (parseInfoLine(StringView(lines[i]), info) && info.depth > finalDepth) {
+                finalDepth = info.depth;
+            }
+        }
+    }
+    checksum = 0;
+    start = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        UciInfo info;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (parseInfoLine(StringView(lines[i]), info, finalDepth, finalDepth) && info.multiPV > 0) {
+                checksum += info.depth + info.multiPV + info.scoreCP + (long)info.pvMove.size;
+            }
+        }
+    }
+    report("tokenizer (depth skip)", std::chrono::duration<double>(Clock::now() - start).count(),
+           lines.size() * passes, bytes * passes, checksum);
+
+    // Legacy parser
+    checksum = 0;
+    start = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        for (size_t i = 0; i < lines.size(); i++) {
+            int depth = 0, multiPV = 0, score = 0;
+            std::string move;
+            if (legacyParse(lines[i], depth, multiPV, score, move)) {
+                checksum += depth + multiPV + score + (long)move.size();
+            }
+        }
+    }
+    report("legacy istringstream", std::chrono::duration<double>(Clock::now() - start).count(),
+           lines.size() * passes, bytes * passes, checksum);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Instant-reply UCI engine for measuring the protocol overhead of the analyzer.
+//
+// Usage: uci_stub              (as engine: --stockfish path/to/uci_stub)
+//        uci_stub -Wuci games.pgn
+//
+// As an engine it answers every "go" at once: one info line per depth and
+// MultiPV line (material score, legal moves only) and a bestmove, so the wall
+// time of a run is the time findepatzer spends around the searches. With
+// -Wuci it writes the games with their moves in UCI notation, like
+// pgn-extract -Wuci, so builds that still need pgn-extract can be measured
+// on the same file (--pgn-extract path/to/uci_stub). See protocol_overhead.sh.
+
+#include "Board.h"
+#include "PgnParser.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static int pieceValue(Piece piece) {
+    static const int values[13] = { 0, 100, 300, 300, 500, 900, 0, -100, -300, -300, -500, -900, 0 };
+    return values[piece];
+}
+
+// Material from the side to move's point of view
+static int materialScore(const Board& board) {
+    int score = 0;
+    for (int square = 0; square < 64; square++) {
+        score += pieceValue(board.getPieceAt(square));
+    }
+    return board.isWhiteToMove() ? score : -score;
+}
+
+static int convert(const char* filename) {
+    PgnParser parser;
+    parser.setWarnings(false);
+    if (!parser.open(filename)) {
+        return 1;
+    }
+    static const char* const tags[] = { "Event", "Site", "Date", "Round", "White", "Black", "Result", "FEN" };
+    Game game;
+    while (parser.nextGame(game)) {
+        for (size_t i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+            if (std::string(tags[i]) == "FEN" && !game.hasStartFen()) {
+                continue;
+            }
+            std::cout << "[" << tags[i] << " \"" << game.getHeader(tags[i]).str() << "\"]\n";
+        }
+        std::cout << "\n";
+        for (size_t ply = 0; ply < game.moves.size(); ply++) {
+            std::cout << Move::packedToUci(game.moves[ply]) << (ply % 8 == 7 ? "\n" : " ");
+        }
+        std::cout << game.getHeader("Result").str() << "\n\n";
+    }
+    return 0;
+}
+
+static void search(Board& board, std::istringstream& in, int multiPV) {
+    int depth = 1;
+    std::vector<std::string> searchMoves;
+    bool inSearchMoves = false;
+    std::string token;
+    while (in >> token) {
+        if (token == "depth") {
+            in >> depth;
+            inSearchMoves = false;
+        }
+        else if (token == "searchmoves") {
+            inSearchMoves = true;
+        }
+        else if (inSearchMoves) {
+            searchMoves.push_back(token);
+        }
+    }
+
+    std::vector<Move> legal;
+    board.generateLegalMoves(legal);
+    std::vector<std::pair<int, std::string> > scored;
+    for (size_t i = 0; i < legal.size(); i++) {
+        std::string uci = legal[i].toUci();
+        if (!searchMoves.empty() && std::find(searchMoves.begin(), searchMoves.end(), uci) == searchMoves.end()) {
+            continue;
+        }
+        board.makeMove(legal[i]);
+        scored.push_back(std::make_pair(-materialScore(board), uci));
+        board.unmakeMove();
+    }
+    if (scored.empty()) {
+        std::cout << "info depth 0 score " << (board.isInCheck() ? "mate 0" : "cp 0") << "\nbestmove (none)\n" << std::flush;
+        return;
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+        [](const std::pair<int, std::string>& a, const std::pair<int, std::string>& b) { return a.first > b.first; });
+
+    int lines = std::min<int>(multiPV, scored.size());
+    for (int d = 1; d <= depth; d++) {
+        for (int i = 0; i < lines; i++) {
+            std::cout << "info depth " << d << " seldepth " << d << " multipv " << (i + 1)
+                      << " score cp " << scored[i].first << " nodes " << (d * 1000)
+                      << " nps 1000000 pv " << scored[i].second << "\n";
+        }
+    }
+    std::cout << "bestmove " << scored[0].second << "\n" << std::flush;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::string(argv[1]) == "-Wuci") {
+        return convert(argv[2]);
+    }
+
+    std::ios::sync_with_stdio(false);
+    Board board;
+    int multiPV = 1;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+        if (command == "uci") {
+            std::cout << "id name uci_stub\nuciok\n" << std::flush;
+        }
+        else if (command == "isready") {
+            std::cout << "readyok\n" << std::flush;
+        }
+        else if (command == "setoption") {
+            std::string token, name, value;
+            in >> token >> name >> token >> value;
+            if (name == "MultiPV") {
+                multiPV = std::max(1, atoi(value.c_str()));
+            }
+        }
+        else if (command == "position") {
+            std::string token;
+            in >> token;
+            board = Board();
+            if (token == "fen") {
+                std::string fen;
+                while (in >> token && token != "moves") {
+                    fen += (fen.empty() ? "" : " ") + token;
+                }
+                board.setFromFen(fen);
+            }
+            else {
+                in >> token;  // "moves"
+            }
+            while (in >> token) {
+                board.makeMove(Move::fromUci(token));
+            }
+        }
+        else if (command == "go") {
+            search(board, in, multiPV);
+        }
+        else if (command == "quit") {
+            break;
+        }
+    }
+    return 0;
+}
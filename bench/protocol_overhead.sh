@@ -0,0 +1,40 @@
+#!/bin/sh
+# Time findepatzer spends per analyzed ply outside the engine's search: the
+# engine is bench/UciStub.cpp, which answers every command at once, so the
+# wall time of the run is protocol, parsing and bookkeeping.
+#
+# Usage: protocol_overhead.sh [findepatzer] [uci_stub] [games.pgn] [depth] [options...]
+#   e.g. bench/protocol_overhead.sh build/findepatzer build/uci_stub dreier.pgn 3
+#
+# Builds that still convert the input with pgn-extract get the stub as
+# --pgn-extract (uci_stub -Wuci), so old and new builds read the same games.
+# Further options are passed to findepatzer.
+
+BIN=${1:-./findepatzer}
+STUB=${2:-./uci_stub}
+PGN=${3:-dreier.pgn}
+DEPTH=${4:-3}
+[ $# -gt 4 ] && shift 4 || shift $#
+
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+# The pgn-extract step writes next to the input
+cp "$PGN" "$TMP/games.pgn" || exit 1
+extract=
+"$BIN" --help 2>&1 | grep -q -- --pgn-extract && extract="--pgn-extract $STUB"
+
+start=$(date +%s.%N)
+"$BIN" "$TMP/games.pgn" --depth "$DEPTH" --threads 1 --stockfish "$STUB" $extract "$@" > "$TMP/out" 2>/dev/null || {
+    echo "run failed" >&2
+    exit 1
+}
+end=$(date +%s.%N)
+
+plies=$(sed -n 's/^ *Total moves to analyze: \([0-9]*\).*/\1/p' "$TMP/out" | awk '{ n += $1 } END { print n + 0 }')
+[ "$plies" -gt 0 ] || {
+    echo "no plies analyzed" >&2
+    exit 1
+}
+awk "BEGIN { t = $end - $start; printf \"%.2f s, %d plies, %.2f ms per ply\n\", t, $plies, 1000 * t / $plies }"
+grep '^Engine searches:' "$TMP/out" || true
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Forward vs backward move order at equal depth: wall time, nodes searched and
+# agreement of the blunder lists. In backward order each engine walks a game
+# from the last move to the first (no ucinewgame in between), so refutations
+# found in later positions are already in the hash table when the earlier
+# positions are searched.
+#
+# Usage: traversal_order.sh [findepatzer] [games.pgn] [depth] [options...]
+#   e.g. bench/traversal_order.sh build/findepatzer dreier.pgn 18 --threads 8
+#
+# Further options are passed to both runs. Leave out --dedup, so every
+# position is searched in its own game.
+
+BIN=${1:-./findepatzer}
+PGN=${2:-dreier.pgn}
+DEPTH=${3:-16}
+[ $# -gt 3 ] && shift 3 || shift $#
+
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+for order in forward backward; do
+    flag=
+    [ "$order" = backward ] && flag=--backward
+    start=$(date +%s.%N)
+    "$BIN" "$PGN" --depth "$DEPTH" $flag "$@" > "$TMP/$order.out" 2>/dev/null || {
+        echo "$order run failed" >&2
+        exit 1
+    }
+    end=$(date +%s.%N)
+    # Blunders as "game move played"
+    sed -n 's/^Game #\([0-9]*\) |.*| Move \([0-9]*[wb]\) | Played: \([a-h1-8qrbn]*\).*/\1 \2 \3/p' \
+        "$TMP/$order.out" | sort > "$TMP/$order.blunders"
+    nodes=$(sed -n 's/^Engine nodes: \([0-9]*\).*/\1/p' "$TMP/$order.out")
+    searches=$(sed -n 's/^Engine searches: \([0-9]*\).*/\1/p' "$TMP/$order.out")
+    blunders=$(wc -l < "$TMP/$order.blunders")
+    printf '%-8s %8.1f s, %6s searches, %14s nodes, %5d blunders\n' \
+        "$order" "$(awk "BEGIN { print $end - $start }")" "$searches" "$nodes" "$blunders"
+done
+
+both=$(comm -12 "$TMP/forward.blunders" "$TMP/backward.blunders" | wc -l)
+either=$(sort -u "$TMP/forward.blunders" "$TMP/backward.blunders" | wc -l)
+echo "Blunder agreement: $both of $either ($(comm -23 "$TMP/forward.blunders" "$TMP/backward.blunders" | wc -l)" \
+     "only forward, $(comm -13 "$TMP/forward.blunders" "$TMP/backward.blunders" | wc -l) only backward)"
+comm -3 "$TMP/forward.blunders" "$TMP/backward.blunders" | sed 's/^\t/  backward: /; t; s/^/  forward:  /'
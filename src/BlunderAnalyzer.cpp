@@ -1,39 +1,161 @@
 #include "BlunderAnalyzer.h"
 #include "Board.h"
-#include "Move.h"
 #include <iostream>
 #include <cstdlib>
 #include <set>
-#include <algorithm>
 #include <cctype>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <utility>
+#include <iomanip>
+#include <algorithm>
 
 BlunderAnalyzer::BlunderAnalyzer(const Config& cfg)
     : config(cfg)
-    , engine(NULL)
+    , totalGames(0)
+    , gamesRead(0)
+    , gamesAnalyzed(0)
+    , totalBlunders(0)
+    , blunderFile(NULL)
+    , totalPlies(0)
+    , triagePositions(0)
+    , triageDeepPositions(0)
+    , chainedPlies(0)
+    , chainFallbacks(0)
 {
-    engine = new StockfishEngine(config.stockfishPath, config.stockfishDepth, config.threads, config.multiPV, config.debugMode);
+    for (int i = 0; i < config.engines; i++) {
+        engines.push_back(new StockfishEngine(config.stockfishPath, config.stockfishDepth, config.threadsPerEngine(),
+                                              config.engineMultiPV(), config.debugMode, i));
+        if (config.analysisMode == "adaptive") {
+            engines[i]->setMultiPVLadder(config.parseMultiPVLadder());
+        }
+        engines[i]->setEarlyStop(config.thresholdCP, config.earlyStop);
+        engines[i]->setNodes(config.nodes);
+        engines[i]->setMoveTime(config.moveTime);
+        engines[i]->setHashSize(config.hashPerEngine());
+        engines[i]->setHashClearInterval(config.hashClearInterval());
+    }
 }
 
 BlunderAnalyzer::~BlunderAnalyzer() {
-    if (engine) {
-        delete engine;
-        engine = NULL;
+    for (size_t i = 0; i < engines.size(); i++) {
+        delete engines[i];
+    }
+    engines.clear();
+
+    if (blunderFile != NULL) {
+        fclose(blunderFile);
     }
 }
 
-// Helper function to normalize UCI moves to lowercase for comparison
-// (e.g., h7h8Q and h7h8q should be treated as the same move)
-static std::string toLowerUCI(const std::string& move) {
-    std::string result = move;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
+// Find the played move among the engine's moves, NULL if absent
+static const MoveScore* findMove(const std::vector<MoveScore>& topMoves, PackedMove move) {
+    for (size_t j = 0; j < topMoves.size(); j++) {
+        if (topMoves[j].move == move) {
+            return &topMoves[j];
+        }
+    }
+    return NULL;
 }
 
-void BlunderAnalyzer::analyzeGames(std::vector<Game>& games) {
-    // Initialize engine
-    if (!engine->initialize()) {
-        std::cerr << "Error: Failed to initialize Stockfish" << std::endl;
-        return;
+// Centipawn loss of the played move (9999 if it is not among the engine's moves)
+static int scoreLoss(const std::vector<MoveScore>& topMoves, PackedMove playedMove) {
+    const MoveScore* played = findMove(topMoves, playedMove);
+    if (topMoves.empty() || played == NULL) {
+        return 9999;
+    }
+    return abs(played->scoreCP - topMoves[0].scoreCP);
+}
+
+// Time budget weight of a search from an earlier result for (or near) its
+// position: evaluations that swung between iterations or a best move that kept
+// changing call for more time than a quiet position
+static double searchWeight(const PlyResult& result) {
+    return 1.0 + std::min(result.scoreSwing, 300) / 100.0 + (result.bestMoveChanged ? 1.0 : 0.0);
+}
+
+namespace {
+
+// Position before a ply of a game as sent to the engine. Anchored positions
+// are the FEN after the last irreversible move (capture or pawn move) plus the
+// moves played since: positions before it cannot repeat, so Stockfish still
+// sees every position its repetition detection needs, but the command stays
+// short instead of replaying the game from the start. Otherwise the position
+// is the start of the game plus every move.
+class EnginePosition {
+public:
+    EnginePosition(const Game& game, bool anchored)
+        : game(game)
+        , anchored(anchored)
+        , ply(0)
+        , start(game.getStartPosition())
+    {
+        if (anchored && game.hasStartFen()) {
+            board.setFromFen(start);
+        }
+    }
+
+    // Play the moves up to the position before the given ply
+    void advanceTo(size_t target) {
+        for (; ply < target; ply++) {
+            PackedMove move = game.moves[ply];
+            if (anchored && !board.makeMove(Move::fromPacked(move))) {
+                anchored = false;  // Board out of sync: keep appending moves to the last anchor
+            }
+            if (anchored && board.getHalfMoveClock() == 0) {
+                start = board.toFen();
+                moves.clear();
+            } else {
+                moves.push_back(move);
+            }
+        }
+    }
+
+    const std::string& getStart() const { return start; }
+    const std::vector<PackedMove>& getMoves() const { return moves; }
+
+private:
+    const Game& game;
+    bool anchored;
+    Board board;
+    size_t ply;
+    std::string start;               // FEN or "startpos"
+    std::vector<PackedMove> moves;
+};
+
+}  // namespace
+
+bool BlunderAnalyzer::analyzeGames(PgnParser& parser) {
+    // Open the evaluation cache
+    if (!config.cacheFile.empty()) {
+        if (!cache.open(config.cacheFile, config.cacheSizeMB)) {
+            return false;
+        }
+        for (size_t i = 0; i < engines.size(); i++) {
+            engines[i]->setCache(&cache);
+        }
+    }
+
+    // Initialize engines
+    for (size_t i = 0; i < engines.size(); i++) {
+        if (!engines[i]->initialize()) {
+            std::cerr << "Error: Failed to initialize Stockfish" << std::endl;
+            return false;
+        }
+    }
+
+    // The blunder listing is printed after the analysis; it is spooled to disk
+    // so memory does not grow with the number of games
+    if (!config.blundersOnly) {
+        blunderFile = tmpfile();
+        if (blunderFile == NULL) {
+            std::cerr << "Error: Cannot create temporary file for the blunder listing" << std::endl;
+            return false;
+        }
     }
 
     // Parse game selection
@@ -42,279 +164,890 @@ void BlunderAnalyzer::analyzeGames(std::vector<Game>& games) {
     std::cout << "=== Findepatzer ===" << std::endl;
     std::cout << "Stockfish depth: " << config.stockfishDepth << std::endl;
     std::cout << "Stockfish threads: " << config.threads << std::endl;
+    if (config.hashPerEngine() > 0 || config.hashClear != "never") {
+        std::cout << "Hash: ";
+        if (config.hashPerEngine() > 0) {
+            std::cout << config.hashPerEngine() << " MB";
+        } else {
+            std::cout << "Stockfish default";
+        }
+        if (config.hashBudgetMB > 0) {
+            std::cout << " per engine (" << config.hashBudgetMB << " MB budget)";
+        }
+        if (config.hashClear == "game") {
+            std::cout << ", cleared before each game";
+        } else if (config.hashClearInterval() > 0) {
+            std::cout << ", cleared every " << config.hashClearInterval() << " moves";
+        }
+        std::cout << std::endl;
+    }
+    if (engines.size() > 1) {
+        std::cout << "Engines: " << engines.size() << " (" << config.threadsPerEngine() << " threads each, "
+                  << (config.plyParallel ? "ply-parallel" : "game-parallel") << ")" << std::endl;
+    }
     std::cout << "Threshold: " << config.thresholdCP << " cp" << std::endl;
     std::cout << "Start move: " << config.startMoveNumber << std::endl;
     if (!selectedGames.empty()) {
         std::cout << "Selected games: " << config.gameSelection << std::endl;
     }
+    std::cout << "Analysis mode: " << config.analysisMode << std::endl;
+    if (config.backward) {
+        std::cout << "Move order: backward (last move first)" << std::endl;
+    }
+    if (config.earlyStop > 0) {
+        std::cout << "Early stop: after " << config.earlyStop << " iterations with the same verdict" << std::endl;
+    }
+    if (config.nodes > 0) {
+        std::cout << "Node limit: " << config.nodes << " per search" << std::endl;
+    }
+    if (config.moveTime > 0) {
+        std::cout << "Movetime: " << config.moveTime << " ms per search" << std::endl;
+    }
+    if (config.timeBudget > 0.0) {
+        std::cout << "Time budget: " << (long)config.timeBudget << " s" << std::endl;
+    }
+    if (cache.isOpen()) {
+        std::cout << "Eval cache: " << config.cacheFile << " (" << cache.getEntries() << " entries)" << std::endl;
+    }
     if (config.blundersOnly) {
         std::cout << "Mode: Blunders only" << std::endl;
     }
-    std::cout << "Total games: " << games.size() << std::endl;
-    std::cout << std::endl;
 
-    // Analyze each game
-    for (size_t i = 0; i < games.size(); i++) {
-        // Check if this game is selected (1-based index)
-        if (!selectedGames.empty() && selectedGames.find(i + 1) == selectedGames.end()) {
-            continue;  // Skip this game
+    // The budget covers the whole run, including the pre-pass
+    if (config.timeBudget > 0.0) {
+        scheduler.start(config.timeBudget, engines.size());
+    }
+
+    // Positions reached by more than one ply are searched once for all of them
+    // (--dedup), and the time budget is spread over the plies of all selected
+    // games. Both need a pass over the input (up to the last selected game)
+    // before the analysis starts; otherwise the first game starts right away.
+    if (config.dedupPositions || scheduler.isActive()) {
+        if (!findSharedPositions(selectedGames)) {
+            return false;
+        }
+        if (totalGames > 0) {
+            std::cout << "Total games: " << totalGames << std::endl;
         }
+        scheduler.setPlies(totalPlies);
+    }
+    if (config.dedupPositions) {
+        std::cout << "Shared positions: " << memo.getSharedPositions() << " reached by "
+                  << memo.getSharedPlies() << " moves" << std::endl;
+        for (size_t i = 0; i < engines.size(); i++) {
+            engines[i]->setMemo(&memo);
+        }
+    }
+    std::cout << std::endl;
 
-        std::cout << "Analyzing game " << (i + 1) << "/" << games.size()
-                  << ": " << games[i].getHeader("White")
-                  << " vs " << games[i].getHeader("Black") << "..." << std::endl;
+    if (engines.size() > 1 && !config.plyParallel) {
+        analyzeGamesParallel(parser, selectedGames);
+    } else {
+        // One game at a time; in ply-parallel mode all engines share each game
+        std::vector<StockfishEngine*> gameEngines(engines.begin(), config.plyParallel ? engines.end() : engines.begin() + 1);
+        Game game;
+        int gameIndex;
+        while (nextGame(parser, selectedGames, game, gameIndex)) {
+            analyzeGame(game, gameIndex, gameEngines, std::cout, gameEngines.size() == 1);
 
-        analyzeGame(games[i], i + 1);
+            std::ostringstream listing;
+            int blunders = formatBlunders(game, gameIndex, listing);
+            recordGame(blunders, listing.str());
+        }
+    }
+
+    if (gamesRead == 0) {
+        std::cerr << "Error: No games found in file" << std::endl;
+        return false;
     }
 
     std::cout << std::endl;
+    return true;
 }
 
-void BlunderAnalyzer::analyzeGame(Game& game, int gameIndex) {
+bool BlunderAnalyzer::nextGame(PgnParser& parser, const std::set<int>& selectedGames, Game& game, int& gameIndex) {
+    while (true) {
+        // Nothing left to do once the last selected game has been read
+        if (!selectedGames.empty() && gamesRead >= static_cast<size_t>(*selectedGames.rbegin())) {
+            return false;
+        }
+        if (!parser.nextGame(game)) {
+            return false;
+        }
+
+        // Selection is 1-based
+        gameIndex = ++gamesRead;
+        if (selectedGames.empty() || selectedGames.find(gameIndex) != selectedGames.end()) {
+            return true;
+        }
+    }
+}
+
+bool BlunderAnalyzer::findSharedPositions(const std::set<int>& selectedGames) {
+    // Illegal moves are reported by the analysis stream
+    PgnParser parser;
+    parser.setWarnings(false);
+    parser.setThreads(config.parseThreads);
+    if (!parser.open(config.inputPgnFile)) {
+        return false;
+    }
+
+    // Stop after the last selected game; the total is then not known
+    size_t gamesSeen = 0;
+    Game game;
+    while (selectedGames.empty() || gamesSeen < static_cast<size_t>(*selectedGames.rbegin())) {
+        if (!parser.nextGame(game)) {
+            totalGames = gamesSeen;
+            break;
+        }
+        gamesSeen++;
+        if (!selectedGames.empty() && selectedGames.find(gamesSeen) == selectedGames.end()) {
+            continue;
+        }
+
+        Board board;
+        if (game.hasStartFen()) {
+            board.setFromFen(game.getHeader("FEN").str());
+        }
+        for (size_t i = 0; i < game.moves.size(); i++) {
+            if (game.getMoveNumber(i) >= config.startMoveNumber) {
+                totalPlies++;
+                if (config.dedupPositions) {
+                    memo.addPosition(board.getHash());
+                }
+            }
+            if (!board.makeMove(Move::fromPacked(game.moves[i]))) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void BlunderAnalyzer::releasePositions(const Game& game) {
+    // Same plies as registered by findSharedPositions()
     Board board;
-    board.setFromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    if (game.hasStartFen()) {
+        board.setFromFen(game.getHeader("FEN").str());
+    }
+    for (size_t i = 0; i < game.moves.size(); i++) {
+        if (game.getMoveNumber(i) >= config.startMoveNumber) {
+            memo.release(board.getHash());
+        }
+        if (!board.makeMove(Move::fromPacked(game.moves[i]))) {
+            break;
+        }
+    }
+}
+
+void BlunderAnalyzer::analyzeGamesParallel(PgnParser& parser, const std::set<int>& selectedGames) {
+    // Each worker owns one engine and pulls the next game from the stream.
+    // Output is buffered per game and flushed strictly in game order; only
+    // games finished ahead of an earlier one are held back.
+    struct GameOutput {
+        std::string text;
+        std::string listing;
+        int blunders;
+    };
+    std::mutex inputMutex;
+    std::mutex outputMutex;
+    size_t nextTask = 0;
+    std::map<size_t, GameOutput> finished;
+    size_t nextToPrint = 0;
+
+    std::vector<std::thread> workers;
+    for (size_t e = 0; e < engines.size(); e++) {
+        workers.push_back(std::thread([&, e]() {
+            Game game;
+            while (true) {
+                size_t task;
+                int gameIndex;
+                {
+                    std::lock_guard<std::mutex> lock(inputMutex);
+                    if (!nextGame(parser, selectedGames, game, gameIndex)) {
+                        break;
+                    }
+                    task = nextTask++;
+                }
+
+                std::ostringstream out;
+                std::ostringstream listing;
+                analyzeGame(game, gameIndex, std::vector<StockfishEngine*>(1, engines[e]), out, false);
+                int blunders = formatBlunders(game, gameIndex, listing);
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                GameOutput& output = finished[task];
+                output.text = out.str();
+                output.listing = listing.str();
+                output.blunders = blunders;
+                for (std::map<size_t, GameOutput>::iterator it = finished.begin();
+                     it != finished.end() && it->first == nextToPrint; it = finished.erase(it)) {
+                    std::cout << it->second.text << std::flush;
+                    recordGame(it->second.blunders, it->second.listing);
+                    nextToPrint++;
+                }
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void BlunderAnalyzer::recordGame(int blunders, const std::string& listing) {
+    gamesAnalyzed++;
+    totalBlunders += blunders;
+    if (blunderFile != NULL && !listing.empty()) {
+        fwrite(listing.data(), 1, listing.size(), blunderFile);
+    }
+}
 
-    // Keep track of all moves from the start (for UCI position command)
-    std::vector<std::string> allMoves;
+void BlunderAnalyzer::analyzeGame(Game& game, int gameIndex, const std::vector<StockfishEngine*>& gameEngines,
+                                  std::ostream& out, bool liveOutput) {
+    out << "Analyzing game " << gameIndex;
+    if (totalGames > 0) {
+        out << "/" << totalGames;
+    }
+    out << ": " << game.getHeader("White")
+        << " vs " << game.getHeader("Black") << "..." << std::endl;
 
-    // Calculate total moves to analyze
-    int totalMovesToAnalyze = 0;
+    // Start each game with an empty hash (--hash-clear game)
+    if (config.hashClear == "game") {
+        for (size_t e = 0; e < gameEngines.size(); e++) {
+            gameEngines[e]->clearHash();
+        }
+    }
+
+    // Collect plies to analyze (moves before startMoveNumber only build up the position)
+    std::vector<size_t> plies;
     for (size_t i = 0; i < game.moves.size(); i++) {
-        int moveNum = (i / 2) + 1;
-        if (moveNum >= config.startMoveNumber) {
-            totalMovesToAnalyze++;
+        if (game.getMoveNumber(i) >= config.startMoveNumber) {
+            plies.push_back(i);
         }
     }
+    int totalMovesToAnalyze = plies.size();
 
     if (!config.blundersOnly) {
-        std::cout << "  Total moves to analyze: " << totalMovesToAnalyze << std::endl;
+        out << "  Total moves to analyze: " << totalMovesToAnalyze << std::endl;
     }
 
-    int analyzedCount = 0;
-    for (size_t i = 0; i < game.moves.size(); i++) {
-        // Calculate current move number
-        int moveNum = (i / 2) + 1;
+    // Show progress indicator in blunders-only mode
+    bool showProgress = config.blundersOnly && liveOutput;
+
+    if (config.triageDepth > 0) {
+        analyzeGameTriage(game, gameIndex, plies, gameEngines, out, showProgress);
+    } else {
+        // Report each ply as soon as it is analyzed
+        if (showProgress && !plies.empty()) {
+            out << "\rAnalyzing move 1/" << totalMovesToAnalyze << "..." << std::flush;
+        }
+        analyzePlies(game, plies, config.stockfishDepth, false, gameEngines, [&](size_t k, PlyResult& result) {
+            scheduler.plyDone();
+            reportPly(game, gameIndex, plies[k], result, out, liveOutput);
+            if (showProgress && k + 1 < plies.size()) {
+                out << "\rAnalyzing move " << (k + 2) << "/" << totalMovesToAnalyze << "..." << std::flush;
+            }
+        });
+    }
 
-        std::string playedMove = game.moves[i];
+    // Clear progress line at the end of game analysis
+    if (showProgress) {
+        out << "\r" << std::string(80, ' ') << "\r" << std::flush;
+    }
 
-        // Skip moves before startMoveNumber (but still track them for position)
-        if (moveNum < config.startMoveNumber) {
-            Move move = Move::fromUci(playedMove);
-            board.makeMove(move);
-            allMoves.push_back(playedMove);
-            continue;
+    if (config.dedupPositions) {
+        releasePositions(game);
+    }
+}
+
+void BlunderAnalyzer::analyzeGameTriage(Game& game, int gameIndex, const std::vector<size_t>& plies,
+                                        const std::vector<StockfishEngine*>& gameEngines,
+                                        std::ostream& out, bool showProgress) {
+    // Pass 1: shallow search of every ply
+    std::vector<PlyResult> results(plies.size());
+    analyzePlies(game, plies, config.triageDepth, false, gameEngines, [&](size_t k, PlyResult& result) {
+        results[k].topMoves.swap(result.topMoves);
+        results[k].bestMoveChanged = result.bestMoveChanged;
+        results[k].depth = result.depth;
+        results[k].scoreSwing = result.scoreSwing;
+        if (showProgress) {
+            out << "\rTriage " << (k + 1) << "/" << plies.size() << "..." << std::flush;
+        }
+    });
+
+    // Flag plies whose shallow loss comes close to the threshold or whose best
+    // move was still changing
+    int lossLimit = (int)(config.thresholdCP * config.triageFraction);
+    std::vector<size_t> deepPlies;
+    std::vector<size_t> deepIndices;
+    std::vector<double> deepWeights;
+    for (size_t k = 0; k < plies.size(); k++) {
+        if (results[k].bestMoveChanged || scoreLoss(results[k].topMoves, game.moves[plies[k]]) > lossLimit) {
+            deepPlies.push_back(plies[k]);
+            deepIndices.push_back(k);
+            deepWeights.push_back(searchWeight(results[k]));
+        }
+    }
+    scheduler.plyDone(plies.size() - deepPlies.size());
+
+    // Pass 2: full-depth search of the flagged plies, keeping their PVs; the
+    // time budget goes to the plies that were volatile in the shallow pass
+    analyzePlies(game, deepPlies, config.stockfishDepth, true, gameEngines, [&](size_t k, PlyResult& result) {
+        scheduler.plyDone();
+        results[deepIndices[k]].topMoves.swap(result.topMoves);
+        results[deepIndices[k]].depth = result.depth;
+        if (showProgress) {
+            out << "\rAnalyzing move " << (k + 1) << "/" << deepPlies.size() << "..." << std::flush;
+        }
+    }, &deepWeights);
+
+    triagePositions += plies.size();
+    triageDeepPositions += deepPlies.size();
+
+    if (!config.blundersOnly) {
+        out << "  Triage: " << deepPlies.size() << " of " << plies.size()
+            << " moves searched at depth " << config.stockfishDepth << std::endl;
+    }
+
+    for (size_t k = 0; k < plies.size(); k++) {
+        reportPly(game, gameIndex, plies[k], results[k], out, showProgress);
+    }
+}
+
+void BlunderAnalyzer::analyzePlies(const Game& game, const std::vector<size_t>& plies, int depth, bool capturePV,
+                                   const std::vector<StockfishEngine*>& gameEngines, const PlyCallback& onResult,
+                                   const std::vector<double>* weights) {
+    for (size_t e = 0; e < gameEngines.size(); e++) {
+        gameEngines[e]->setCapturePV(capturePV);
+    }
+
+    if (plies.empty()) {
+        return;
+    }
+
+    if (gameEngines.size() > 1 || config.backward) {
+        // Fan the plies out to all engines (or walk them backwards on one), then
+        // hand them over in ply order
+        std::vector<PlyResult> results = analyzePliesParallel(game, plies, depth, gameEngines, weights);
+        for (size_t k = 0; k < plies.size(); k++) {
+            if (config.analysisMode == "chain") {
+                bool haveNext = (k + 1 < plies.size() && plies[k + 1] == plies[k] + 1);
+                chainPly(*gameEngines[0], game, plies[k], depth, results[k], haveNext ? &results[k + 1] : NULL);
+            }
+            onResult(k, results[k]);
         }
+        return;
+    }
+
+    StockfishEngine& engine = *gameEngines[0];
+    bool chain = (config.analysisMode == "chain");
+    PlyResult pending;  // Chain mode: previous ply, waiting for this position's result
+
+    // The board follows the game so each position can be sent from its anchor
+    EnginePosition position(game, config.positionMode == "fen");
+    position.advanceTo(plies[0]);
 
-        analyzedCount++;
-        std::string side = (i % 2 == 0) ? "White" : "Black";
+    // Searches are pipelined: the next position is sent as soon as the current
+    // bestmove arrives, so Stockfish searches while we evaluate and print
+    prepareSearch(engine, depth, weights != NULL ? (*weights)[0] : 1.0);
+    engine.startAnalysis(position.getStart(), position.getMoves(), depth, std::vector<PackedMove>(), game.moves[plies[0]]);
 
-        // Show progress indicator in blunders-only mode
-        if (config.blundersOnly) {
-            std::cout << "\rAnalyzing move " << analyzedCount << "/" << totalMovesToAnalyze << "..." << std::flush;
+    for (size_t k = 0; k < plies.size(); k++) {
+        // Collect the MultiPV top moves for this position
+        PlyResult result;
+        result.topMoves = engine.finishAnalysis();
+        result.bestMoveChanged = engine.bestMoveChanged();
+        result.depth = engine.lastDepth();
+        result.scoreSwing = engine.lastScoreSwing();
+        completePly(engine, position.getStart(), position.getMoves(), game.moves[plies[k]], depth, result);
+
+        // A direct search for the previous ply must run before the next search is queued
+        if (chain && k > 0) {
+            chainPly(engine, game, plies[k - 1], depth, pending, plies[k] == plies[k - 1] + 1 ? &result : NULL);
         }
 
-        // 1. Analyze position with MultiPV to get all top moves
-        std::vector<MoveScore> topMoves = engine->analyzePosition("startpos", allMoves, config.stockfishDepth);
+        if (k + 1 < plies.size()) {
+            position.advanceTo(plies[k + 1]);
+            prepareSearch(engine, depth, weights != NULL ? (*weights)[k + 1] : searchWeight(result));
+            engine.startAnalysis(position.getStart(), position.getMoves(), depth, std::vector<PackedMove>(),
+                                 game.moves[plies[k + 1]]);
+        }
 
-        if (topMoves.empty()) {
-            std::cout << "  Move " << moveNum << side[0] << ": " << playedMove
-                      << " | ERROR: No moves from engine" << std::endl;
+        if (!chain) {
+            onResult(k, result);
             continue;
         }
+        if (k > 0) {
+            onResult(k - 1, pending);
+        }
+        pending = std::move(result);
+    }
 
-        // 2. Best move is always first (multipv 1)
-        MoveScore bestMove = topMoves[0];
+    // The last ply has no following position to borrow the score from
+    if (chain) {
+        chainPly(engine, game, plies.back(), depth, pending, NULL);
+        onResult(plies.size() - 1, pending);
+    }
+}
 
-        // 3. Find the played move in the top moves list
-        // Normalize to lowercase for comparison (h7h8Q == h7h8q)
-        MoveScore* playedMoveScore = nullptr;
-        std::string playedMoveLower = toLowerUCI(playedMove);
-        for (size_t j = 0; j < topMoves.size(); j++) {
-            if (toLowerUCI(topMoves[j].move) == playedMoveLower) {
-                playedMoveScore = &topMoves[j];
-                break;
+namespace {
+
+// Work-stealing ply queues. Each engine starts with a contiguous block of plies
+// and works through it front to back (or back to front), so consecutive searches
+// on one engine are neighbouring positions that hit its warm hash table. An
+// engine that runs dry steals the half of the largest remaining block that its
+// owner would reach last.
+class PlyQueues {
+public:
+    PlyQueues(size_t numPlies, size_t numQueues, bool backward)
+        : queues(numQueues)
+        , backward(backward)
+    {
+        for (size_t q = 0; q < numQueues; q++) {
+            size_t begin = numPlies * q / numQueues;
+            size_t end = numPlies * (q + 1) / numQueues;
+            for (size_t k = begin; k < end; k++) {
+                queues[q].push_back(k);
             }
         }
+    }
 
-        // 4. Calculate score difference
-        int scoreDiff;
-        int playedScore;
-        bool isMate = bestMove.isMate;
-        int mateInN = bestMove.mateInN;
+    // Get next task for a queue; returns false when all work is done
+    bool next(size_t queue, size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex);
 
-        if (playedMoveScore != nullptr) {
-            // Played move found in top moves
-            playedScore = playedMoveScore->scoreCP;
-            scoreDiff = abs(playedScore - bestMove.scoreCP);
-            if (playedMoveScore->isMate) {
-                isMate = true;
-                mateInN = playedMoveScore->mateInN;
+        if (queues[queue].empty()) {
+            size_t victim = queue;
+            for (size_t q = 0; q < queues.size(); q++) {
+                if (queues[q].size() > queues[victim].size()) {
+                    victim = q;
+                }
             }
-        } else {
-            // Played move NOT in top 200 - it's extremely bad!
-            playedScore = -9999;  // Placeholder for "very bad"
-            scoreDiff = 9999;  // Mark as huge blunder
-        }
-
-        // 5. Check if this is a blunder
-        bool isBlunder = (playedMoveScore == nullptr) || (scoreDiff > config.thresholdCP);
-
-        // 6. Format and display the result
-        // In blunders-only mode, only show blunders immediately
-        // In normal mode, show all moves
-        if (!config.blundersOnly || isBlunder) {
-            // In blunders-only mode, show game info for context
-            if (config.blundersOnly && isBlunder) {
-                std::cout << "Game #" << gameIndex << " | "
-                          << "White: " << game.getHeader("White") << " | "
-                          << "Black: " << game.getHeader("Black") << " | ";
+            if (queues[victim].empty()) {
+                return false;
+            }
+
+            std::deque<size_t>& from = queues[victim];
+            size_t stealCount = (from.size() + 1) / 2;
+            if (backward) {
+                queues[queue].assign(from.begin(), from.begin() + stealCount);
+                from.erase(from.begin(), from.begin() + stealCount);
             } else {
-                std::cout << "  ";
+                queues[queue].assign(from.end() - stealCount, from.end());
+                from.erase(from.end() - stealCount, from.end());
             }
+        }
 
-            std::cout << moveNum << side[0] << " " << playedMove << " | ";
+        if (backward) {
+            task = queues[queue].back();
+            queues[queue].pop_back();
+        } else {
+            task = queues[queue].front();
+            queues[queue].pop_front();
+        }
+        return true;
+    }
 
-            // Best move
-            std::cout << "Best: " << bestMove.move << " (";
-            if (bestMove.isMate) {
-                std::cout << (bestMove.mateInN > 0 ? "+" : "") << "M" << abs(bestMove.mateInN);
-            } else {
-                std::cout << (bestMove.scoreCP > 0 ? "+" : "") << bestMove.scoreCP << "cp";
+private:
+    std::mutex mutex;
+    std::vector<std::deque<size_t> > queues;
+    bool backward;
+};
+
+}  // namespace
+
+std::vector<PlyResult> BlunderAnalyzer::analyzePliesParallel(const Game& game, const std::vector<size_t>& plies, int depth,
+                                                             const std::vector<StockfishEngine*>& gameEngines,
+                                                             const std::vector<double>* weights) {
+    std::vector<PlyResult> results(plies.size());
+    PlyQueues queues(plies.size(), gameEngines.size(), config.backward);
+
+    std::vector<std::thread> workers;
+    for (size_t e = 0; e < gameEngines.size(); e++) {
+        workers.push_back(std::thread([&, e]() {
+            size_t task;
+            double weight = 1.0;  // From the engine's previous ply (a neighbour of the next one)
+            while (queues.next(e, task)) {
+                EnginePosition position(game, config.positionMode == "fen");
+                position.advanceTo(plies[task]);
+                prepareSearch(*gameEngines[e], depth, weights != NULL ? (*weights)[task] : weight);
+                results[task].topMoves = gameEngines[e]->analyzePosition(position.getStart(), position.getMoves(), depth,
+                                                                         std::vector<PackedMove>(), game.moves[plies[task]]);
+                results[task].bestMoveChanged = gameEngines[e]->bestMoveChanged();
+                results[task].depth = gameEngines[e]->lastDepth();
+                results[task].scoreSwing = gameEngines[e]->lastScoreSwing();
+                completePly(*gameEngines[e], position.getStart(), position.getMoves(), game.moves[plies[task]], depth,
+                            results[task]);
+                weight = searchWeight(results[task]);
             }
-            std::cout << ") | ";
-
-            // Played move
-            std::cout << "Played: " << playedMove << " (";
-            if (playedMoveScore != nullptr) {
-                if (playedMoveScore->isMate) {
-                    std::cout << (playedMoveScore->mateInN > 0 ? "+" : "") << "M" << abs(playedMoveScore->mateInN);
-                } else {
-                    std::cout << (playedScore > 0 ? "+" : "") << playedScore << "cp";
-                }
+        }));
+    }
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    return results;
+}
+
+void BlunderAnalyzer::prepareSearch(StockfishEngine& engine, int depth, double weight) {
+    engine.beginPly();
+
+    // Shallow triage searches stay depth-limited
+    if (scheduler.isActive()) {
+        engine.setMoveTime(depth == config.stockfishDepth ? scheduler.allocate(weight) : 0);
+    }
+}
+
+void BlunderAnalyzer::completePly(StockfishEngine& engine, const std::string& startPosition,
+                                  const std::vector<PackedMove>& movesToPosition,
+                                  PackedMove playedMove, int depth, PlyResult& result) {
+    if (config.analysisMode == "adaptive") {
+        // Raise MultiPV until the played move is among the top moves; the last
+        // tier searched settles the verdict
+        engine.escalateMultiPV(startPosition, movesToPosition, depth, playedMove, result.topMoves);
+        result.depth = engine.lastDepth();
+        return;
+    }
+
+    if (config.analysisMode == "searchmoves") {
+        scorePlayedMove(engine, startPosition, movesToPosition, playedMove, depth, result);
+    }
+}
+
+void BlunderAnalyzer::scorePlayedMove(StockfishEngine& engine, const std::string& startPosition,
+                                      const std::vector<PackedMove>& movesToPosition,
+                                      PackedMove playedMove, int depth, PlyResult& result) {
+    std::vector<MoveScore>& topMoves = result.topMoves;
+    if (topMoves.empty()) {
+        return;
+    }
+
+    // The MultiPV 1 search found the best move; unless that is the played move,
+    // score the played move with a search restricted to it (same engine, warm hash)
+    if (topMoves[0].move == playedMove) {
+        return;
+    }
+
+    std::vector<MoveScore> played = engine.analyzePosition(startPosition, movesToPosition, depth,
+                                                           std::vector<PackedMove>(1, playedMove));
+    if (!played.empty() && played[0].move == playedMove) {
+        played[0].multiPVIndex = topMoves.size() + 1;
+        topMoves.push_back(played[0]);
+    }
+
+    // The verdict compares both searches, so it is only as deep as the shallower one
+    result.depth = std::min(result.depth, engine.lastDepth());
+}
+
+void BlunderAnalyzer::chainPly(StockfishEngine& engine, const Game& game, size_t ply, int depth,
+                               PlyResult& result, const PlyResult* next) {
+    PackedMove playedMove = game.moves[ply];
+    if (result.topMoves.empty() || findMove(result.topMoves, playedMove) != NULL) {
+        return;
+    }
+
+    // The played move leads to the next position, so its score is the negated
+    // best score there, provided both searches completed the same depth
+    if (next != NULL && !next->topMoves.empty() && next->depth == result.depth) {
+        const MoveScore& reply = next->topMoves[0];
+        MoveScore played;
+        played.move = playedMove;
+        played.scoreCP = -reply.scoreCP;
+        played.isMate = reply.isMate;
+        if (reply.isMate) {
+            // Opponent mates in N -> mated in N; opponent is mated in N -> mate in N+1
+            played.mateInN = reply.mateInN > 0 ? -reply.mateInN : -reply.mateInN + 1;
+        }
+        played.multiPVIndex = result.topMoves.size() + 1;
+        result.topMoves.push_back(played);
+        chainedPlies++;
+        return;
+    }
+
+    EnginePosition position(game, config.positionMode == "fen");
+    position.advanceTo(ply);
+    scorePlayedMove(engine, position.getStart(), position.getMoves(), playedMove, depth, result);
+    chainFallbacks++;
+}
+
+void BlunderAnalyzer::reportPly(Game& game, int gameIndex, size_t ply, const PlyResult& result,
+                                std::ostream& out, bool liveOutput) {
+    const std::vector<MoveScore>& topMoves = result.topMoves;
+    int moveNum = game.getMoveNumber(ply);
+    std::string side = game.isWhiteMove(ply) ? "White" : "Black";
+    std::string playedMove = Move::packedToUci(game.moves[ply]);
+
+    if (topMoves.empty()) {
+        out << "  Move " << moveNum << side[0] << ": " << playedMove
+            << " | ERROR: No moves from engine" << std::endl;
+        return;
+    }
+
+    // 1. Best move is always first (multipv 1)
+    MoveScore bestMove = topMoves[0];
+
+    // 2. Find the played move in the top moves list
+    const MoveScore* playedMoveScore = findMove(topMoves, game.moves[ply]);
+
+    // 3. Calculate score difference
+    int scoreDiff;
+    int playedScore;
+    bool isMate = bestMove.isMate;
+    int mateInN = bestMove.mateInN;
+
+    if (playedMoveScore != nullptr) {
+        // Played move found in top moves
+        playedScore = playedMoveScore->scoreCP;
+        scoreDiff = abs(playedScore - bestMove.scoreCP);
+        if (playedMoveScore->isMate) {
+            isMate = true;
+            mateInN = playedMoveScore->mateInN;
+        }
+    } else {
+        // Played move NOT in top 200 - it's extremely bad!
+        playedScore = -9999;  // Placeholder for "very bad"
+        scoreDiff = 9999;  // Mark as huge blunder
+    }
+
+    // 4. Check if this is a blunder
+    bool isBlunder = (playedMoveScore == nullptr) || (scoreDiff > config.thresholdCP);
+
+    // 5. Format and display the result
+    // In blunders-only mode, only show blunders immediately
+    // In normal mode, show all moves
+    if (!config.blundersOnly || isBlunder) {
+        // In blunders-only mode, show game info for context
+        if (config.blundersOnly && isBlunder) {
+            out << "Game #" << gameIndex << " | "
+                << "White: " << game.getHeader("White") << " | "
+                << "Black: " << game.getHeader("Black") << " | ";
+        } else {
+            out << "  ";
+        }
+
+        out << moveNum << side[0] << " " << playedMove << " | ";
+
+        // Best move
+        out << "Best: " << Move::packedToUci(bestMove.move) << " (";
+        if (bestMove.isMate) {
+            out << (bestMove.mateInN > 0 ? "+" : "") << "M" << abs(bestMove.mateInN);
+        } else {
+            out << (bestMove.scoreCP > 0 ? "+" : "") << bestMove.scoreCP << "cp";
+        }
+        out << ") | ";
+
+        // Played move
+        out << "Played: " << playedMove << " (";
+        if (playedMoveScore != nullptr) {
+            if (playedMoveScore->isMate) {
+                out << (playedMoveScore->mateInN > 0 ? "+" : "") << "M" << abs(playedMoveScore->mateInN);
             } else {
-                std::cout << "not in top " << config.multiPV;
+                out << (playedScore > 0 ? "+" : "") << playedScore << "cp";
             }
-            std::cout << ") | ";
+        } else {
+            out << "not in top " << topMoves.size();
+        }
+        out << ") | ";
 
-            // Difference
-            std::cout << "Diff: " << scoreDiff << "cp";
+        // Difference
+        out << "Diff: " << scoreDiff << "cp";
 
-            // Verdict
-            if (playedMoveScore == nullptr) {
-                std::cout << " [EXTREME BLUNDER]";
-            } else if (scoreDiff > config.thresholdCP) {
-                std::cout << " [BLUNDER]";
-            }
+        // Depth the verdict was taken at (below --depth if the search stopped early)
+        if (config.limitsDepth()) {
+            out << " | Depth: " << result.depth;
+        }
 
-            std::cout << std::endl;
-        } else if (config.blundersOnly && !isBlunder) {
-            // Clear the progress line if no blunder (move was good)
-            std::cout << "\r" << std::string(80, ' ') << "\r" << std::flush;
+        // Verdict
+        if (playedMoveScore == nullptr) {
+            out << " [EXTREME BLUNDER]";
+        } else if (scoreDiff > config.thresholdCP) {
+            out << " [BLUNDER]";
         }
 
-        // 6. Store analysis
-        MoveAnalysis analysis;
-        analysis.moveNumber = moveNum;
-        analysis.playedMove = playedMove;
-        analysis.playedScore = playedScore;
-        analysis.bestMove = bestMove.move;
-        analysis.bestScore = bestMove.scoreCP;
-        analysis.scoreDifference = scoreDiff;
-        analysis.isMateScore = isMate;
-        analysis.mateInN = mateInN;
+        // Principal variation (only captured by the triage deep pass)
+        if (isBlunder && !bestMove.pv.empty()) {
+            out << " | PV: " << bestMove.pv;
+        }
 
-        game.addAnalysis(analysis);
+        out << std::endl;
+    } else if (config.blundersOnly && liveOutput) {
+        // Clear the progress line if no blunder (move was good)
+        out << "\r" << std::string(80, ' ') << "\r" << std::flush;
+    }
 
-        // 7. Make the played move on the board and add to move list
-        Move move = Move::fromUci(playedMove);
-        board.makeMove(move);
-        allMoves.push_back(playedMove);
+    // 6. Store analysis
+    MoveAnalysis analysis;
+    analysis.moveNumber = moveNum;
+    analysis.whiteMove = game.isWhiteMove(ply);
+    analysis.playedMove = game.moves[ply];
+    analysis.playedScore = playedScore;
+    analysis.bestMove = bestMove.move;
+    analysis.bestScore = bestMove.scoreCP;
+    analysis.scoreDifference = scoreDiff;
+    analysis.isMateScore = isMate;
+    analysis.mateInN = mateInN;
+    analysis.decisionDepth = result.depth;
+    analysis.bestLine = bestMove.pv;
+    if (playedMoveScore != nullptr) {
+        analysis.playedLine = playedMoveScore->pv;
     }
 
-    // Clear progress line at the end of game analysis
+    game.addAnalysis(analysis);
+}
+
+int BlunderAnalyzer::formatBlunders(const Game& game, int gameIndex, std::ostream& out) const {
+    std::vector<MoveAnalysis> blunders = game.getBlunders(config.thresholdCP);
+
+    // In blunders-only mode the blunders were already printed during analysis,
+    // so they are only counted for the summary
     if (config.blundersOnly) {
-        std::cout << "\r" << std::string(80, ' ') << "\r" << std::flush;
+        return blunders.size();
     }
-}
 
-void BlunderAnalyzer::outputBlunders(const std::vector<Game>& games) {
-    int totalBlunders = 0;
+    for (size_t i = 0; i < blunders.size(); i++) {
+        const MoveAnalysis& blunder = blunders[i];
 
-    // In blunders-only mode, we already printed blunders during analysis
-    // So we just need to count them for the summary
-    if (!config.blundersOnly) {
-        std::cout << "=== Blunders Found ===" << std::endl;
-        std::cout << std::endl;
+        // Format: Game #N | White | Black | Move Nw/b | Played (score) | Best (score) | Loss
+        out << "Game #" << gameIndex
+            << " | White: " << game.getHeader("White")
+            << " | Black: " << game.getHeader("Black")
+            << " | Move " << blunder.moveNumber << (blunder.whiteMove ? "w" : "b")
+            << " | Played: " << Move::packedToUci(blunder.playedMove);
 
-        for (size_t gameIdx = 0; gameIdx < games.size(); gameIdx++) {
-            const Game& game = games[gameIdx];
-            std::vector<MoveAnalysis> blunders = game.getBlunders(config.thresholdCP);
-
-            for (size_t i = 0; i < blunders.size(); i++) {
-                const MoveAnalysis& blunder = blunders[i];
-
-                // Determine side that moved (even index = white, odd = black in 0-based)
-                // But we need to look at the actual move number
-                bool isWhiteMove = (blunder.moveNumber * 2 - 1) <= static_cast<int>(game.moves.size()) &&
-                                   (game.moves.size() > 0 &&
-                                    (blunder.playedMove == game.moves[(blunder.moveNumber - 1) * 2] ||
-                                     (blunder.moveNumber == 1 && blunder.playedMove == game.moves[0])));
-
-                // Find position in move list
-                std::string sideLetter = "?";
-                for (size_t j = 0; j < game.moves.size(); j++) {
-                    if (game.moves[j] == blunder.playedMove) {
-                        sideLetter = (j % 2 == 0) ? "w" : "b";
-                        break;
-                    }
-                }
+        if (blunder.isMateScore && blunder.playedScore > 5000) {
+            out << " (mate)";
+        } else if (blunder.isMateScore && blunder.playedScore < -5000) {
+            out << " (-mate)";
+        } else {
+            out << " (";
+            if (blunder.playedScore > 0) out << "+";
+            out << blunder.playedScore << "cp)";
+        }
 
-                // Format: Game #N | White | Black | Move Nw/b | Played (score) | Best (score) | Loss
-                std::cout << "Game #" << (gameIdx + 1)
-                          << " | White: " << game.getHeader("White")
-                          << " | Black: " << game.getHeader("Black")
-                          << " | Move " << blunder.moveNumber << sideLetter
-                          << " | Played: " << blunder.playedMove;
-
-                if (blunder.isMateScore && blunder.playedScore > 5000) {
-                    std::cout << " (mate)";
-                } else if (blunder.isMateScore && blunder.playedScore < -5000) {
-                    std::cout << " (-mate)";
-                } else {
-                    std::cout << " (";
-                    if (blunder.playedScore > 0) std::cout << "+";
-                    std::cout << blunder.playedScore << "cp)";
-                }
+        out << " | Best: " << Move::packedToUci(blunder.bestMove);
+
+        if (blunder.isMateScore && blunder.bestScore > 5000) {
+            out << " (mate)";
+        } else if (blunder.isMateScore && blunder.bestScore < -5000) {
+            out << " (-mate)";
+        } else {
+            out << " (";
+            if (blunder.bestScore > 0) out << "+";
+            out << blunder.bestScore << "cp)";
+        }
 
-                std::cout << " | Best: " << blunder.bestMove;
+        out << " | Loss: " << blunder.scoreDifference << "cp";
+        if (config.limitsDepth()) {
+            out << " | Depth: " << blunder.decisionDepth;
+        }
+        if (!blunder.bestLine.empty()) {
+            out << " | PV: " << blunder.bestLine;
+        }
+        out << std::endl;
+    }
 
-                if (blunder.isMateScore && blunder.bestScore > 5000) {
-                    std::cout << " (mate)";
-                } else if (blunder.isMateScore && blunder.bestScore < -5000) {
-                    std::cout << " (-mate)";
-                } else {
-                    std::cout << " (";
-                    if (blunder.bestScore > 0) std::cout << "+";
-                    std::cout << blunder.bestScore << "cp)";
-                }
+    return blunders.size();
+}
 
-                std::cout << " | Loss: " << blunder.scoreDifference << "cp"
-                          << std::endl;
+void BlunderAnalyzer::outputBlunders() {
+    // Copy the spooled listing
+    if (!config.blundersOnly) {
+        std::cout << "=== Blunders Found ===" << std::endl;
+        std::cout << std::endl;
 
-                totalBlunders++;
+        if (blunderFile != NULL) {
+            rewind(blunderFile);
+            char buffer[65536];
+            size_t n;
+            while ((n = fread(buffer, 1, sizeof(buffer), blunderFile)) > 0) {
+                std::cout.write(buffer, n);
             }
         }
-    } else {
-        // Just count blunders for summary
-        for (size_t gameIdx = 0; gameIdx < games.size(); gameIdx++) {
-            const Game& game = games[gameIdx];
-            std::vector<MoveAnalysis> blunders = game.getBlunders(config.thresholdCP);
-            totalBlunders += blunders.size();
-        }
     }
 
     std::cout << std::endl;
     std::cout << "=== Summary ===" << std::endl;
-    std::cout << "Total games analyzed: " << games.size() << std::endl;
+    std::cout << "Total games analyzed: " << gamesAnalyzed << std::endl;
     std::cout << "Total blunders found: " << totalBlunders << std::endl;
+
+    // Engine timing (per-ply cost including protocol overhead)
+    EngineStats engineStats;
+    for (size_t i = 0; i < engines.size(); i++) {
+        engineStats.add(engines[i]->getStats());
+    }
+    if (engineStats.searches > 0) {
+        std::cout << "Engine searches: " << engineStats.searches
+                  << " (" << std::fixed << std::setprecision(1)
+                  << (1000.0 * engineStats.searchSeconds / engineStats.searches) << " ms per search)" << std::endl;
+        if (engineStats.searchSeconds > 0) {
+            std::cout << "Engine output: " << (engineStats.bytesRead / 1048576.0) << " MB, "
+                      << engineStats.linesRead << " lines ("
+                      << (engineStats.bytesRead / 1048576.0 / engineStats.searchSeconds) << " MB/s, "
+                      << (long)(engineStats.linesRead / engineStats.searchSeconds) << " lines/s)" << std::endl;
+        }
+        std::cout << "Engine input: " << (engineStats.bytesWritten / 1024.0) << " KB ("
+                  << (engineStats.bytesWritten / engineStats.searches) << " bytes per search)" << std::endl;
+        std::cout << "Engine nodes: " << engineStats.nodes << " ("
+                  << (engineStats.nodes / engineStats.searches) << " per search)" << std::endl;
+    }
+
+    // Searches of shared positions answered for other games
+    if (config.dedupPositions) {
+        std::cout << "Shared positions: " << memo.getHits() << " engine searches saved" << std::endl;
+    }
+
+    // Searches answered from the persistent cache
+    if (cache.isOpen()) {
+        long lookups = cache.getHits() + cache.getMisses();
+        std::cout << "Eval cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses ("
+                  << std::fixed << std::setprecision(1) << (lookups > 0 ? 100.0 * cache.getHits() / lookups : 0.0)
+                  << "% hit rate), " << cache.getEntries() << " entries"
+                  << (cache.isFull() ? " (full)" : "") << std::endl;
+    }
+
+    // Share of positions the triage pass sent to the full-depth search
+    if (config.triageDepth > 0 && triagePositions > 0) {
+        std::cout << "Triage: deep search for " << triageDeepPositions << " of " << triagePositions
+                  << " positions (" << std::fixed << std::setprecision(1)
+                  << (100.0 * triageDeepPositions / triagePositions) << "%)" << std::endl;
+    }
+
+    // Searches ended before the requested depth because the verdict was settled
+    if (config.earlyStop > 0) {
+        std::cout << "Early stop: " << engineStats.earlyStops << " of " << engineStats.searches << " searches";
+        if (engineStats.earlyStops > 0) {
+            std::cout << " (at depth " << std::fixed << std::setprecision(1)
+                      << ((double)engineStats.earlyStopDepths / engineStats.earlyStops) << " on average)";
+        }
+        std::cout << std::endl;
+    }
+
+    // ucinewgame commands sent (--hash-clear)
+    if (config.hashClear != "never") {
+        std::cout << "Hash clears: " << engineStats.hashClears << std::endl;
+    }
+
+    // Wall-clock time of the run against its budget
+    if (scheduler.isActive()) {
+        std::cout << "Time budget: " << std::fixed << std::setprecision(0) << scheduler.getElapsed() << " s of "
+                  << config.timeBudget << " s used" << std::endl;
+    }
+
+    // How many played moves chain mode scored without a search of their own
+    if (config.analysisMode == "chain") {
+        std::cout << "Ply chaining: " << chainedPlies << " played moves scored from the next position, "
+                  << chainFallbacks << " direct searches" << std::endl;
+    }
+
+    // How often each adaptive MultiPV tier settled a position
+    if (config.analysisMode == "adaptive") {
+        std::vector<int> ladder = config.parseMultiPVLadder();
+        std::cout << "MultiPV tiers:";
+        for (size_t i = 0; i < ladder.size() && i < engineStats.tierHits.size(); i++) {
+            std::cout << (i > 0 ? "," : "") << " " << ladder[i] << ": " << engineStats.tierHits[i];
+        }
+        std::cout << " (not found: " << engineStats.tierMisses << ")" << std::endl;
+    }
 }
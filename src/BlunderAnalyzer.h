@@ -4,24 +4,138 @@
 #include "Config.h"
 #include "Game.h"
 #include "StockfishEngine.h"
+#include "EvalCache.h"
+#include "PositionMemo.h"
+#include "SearchScheduler.h"
+#include "PgnParser.h"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <set>
 #include <vector>
+#include <ostream>
+
+// Engine result for one ply
+struct PlyResult {
+    std::vector<MoveScore> topMoves;
+    bool bestMoveChanged;               // Best move differed between the last two complete iterations
+    int depth;                          // Depth of the last complete iteration
+    int scoreSwing;                     // Largest best-score change between iterations
+
+    PlyResult() : bestMoveChanged(false), depth(0), scoreSwing(0) {}
+};
+
+// Receives the result for plies[k]; called in ply order
+typedef std::function<void(size_t k, PlyResult& result)> PlyCallback;
 
 class BlunderAnalyzer {
 public:
     BlunderAnalyzer(const Config& config);
     ~BlunderAnalyzer();
 
-    // Analyze all games and populate analysis data
-    void analyzeGames(std::vector<Game>& games);
+    // Analyze the games of the stream one at a time as they are read; only the
+    // summary (blunder count and listing) is kept. Returns false if the engines
+    // could not be started or the stream held no games.
+    bool analyzeGames(PgnParser& parser);
 
     // Output blunders found in all games
-    void outputBlunders(const std::vector<Game>& games);
+    void outputBlunders();
 
 private:
     Config config;
-    StockfishEngine* engine;
+    std::vector<StockfishEngine*> engines;  // Engine pool (config.engines processes)
+    size_t totalGames;                      // Games in the input file (0 if not known up front)
+    size_t gamesRead;                       // Games pulled from the stream so far
+    size_t gamesAnalyzed;
+    int totalBlunders;
+    std::FILE* blunderFile;                 // Blunder listing, spooled to a temporary file
+    EvalCache cache;                        // Shared by all engines (--cache)
+    PositionMemo memo;                      // Positions reached by several plies of the selected games
+    SearchScheduler scheduler;              // Movetimes from the run's time budget (--time-budget)
+    size_t totalPlies;                      // Plies to analyze in the selected games (pre-pass)
+    std::atomic<long> triagePositions;      // Positions searched by the triage pass
+    std::atomic<long> triageDeepPositions;  // ... of which were re-searched at full depth
+    std::atomic<long> chainedPlies;         // Chain mode: played moves scored from the next position
+    std::atomic<long> chainFallbacks;       // Chain mode: played moves that needed a direct search
+
+    // Analyze one game, writing per-move output to out. With more than one engine
+    // the plies of the game are spread across them (ply-parallel mode).
+    // liveOutput enables the \r progress indicator (only useful on a terminal stream).
+    void analyzeGame(Game& game, int gameIndex, const std::vector<StockfishEngine*>& gameEngines,
+                     std::ostream& out, bool liveOutput);
+
+    // Two-pass analysis: search all plies at triageDepth, re-search at full depth
+    // only those close to the blunder threshold or with an unstable best move
+    void analyzeGameTriage(Game& game, int gameIndex, const std::vector<size_t>& plies,
+                           const std::vector<StockfishEngine*>& gameEngines,
+                           std::ostream& out, bool showProgress);
+
+    // Search the given plies (ascending) at depth and pass each result to onResult.
+    // One engine pipelines the searches, several engines share them (ply-parallel).
+    // In backward order all results are collected before the first is passed on.
+    // weights (one per ply) size the time budget shares; without them each search
+    // is weighted by the result the engine got for its previous ply.
+    void analyzePlies(const Game& game, const std::vector<size_t>& plies, int depth, bool capturePV,
+                      const std::vector<StockfishEngine*>& gameEngines, const PlyCallback& onResult,
+                      const std::vector<double>* weights = NULL);
+
+    // Analyze the given plies of one game on several engines (work-stealing),
+    // each engine working through its share in the configured order; results are
+    // returned in the order of plies
+    std::vector<PlyResult> analyzePliesParallel(const Game& game, const std::vector<size_t>& plies, int depth,
+                                                const std::vector<StockfishEngine*>& gameEngines,
+                                                const std::vector<double>* weights);
+
+    // Before the first search of a ply: count it towards the engine's hash clear
+    // interval and, with a time budget, give a full-depth search its movetime,
+    // sized by weight (1 = average; see searchWeight())
+    void prepareSearch(StockfishEngine& engine, int depth, double weight);
+
+    // Mode-specific follow-up searches after the first search of a position
+    // (searchmoves mode: score the played move with a restricted search,
+    // adaptive mode: raise MultiPV until the played move is found); result.depth
+    // becomes the depth the verdict rests on
+    void completePly(StockfishEngine& engine, const std::string& startPosition,
+                     const std::vector<PackedMove>& movesToPosition,
+                     PackedMove playedMove, int depth, PlyResult& result);
+
+    // Score the played move with a search restricted to it (unless it is the best move)
+    void scorePlayedMove(StockfishEngine& engine, const std::string& startPosition,
+                         const std::vector<PackedMove>& movesToPosition,
+                         PackedMove playedMove, int depth, PlyResult& result);
+
+    // Chain mode: score the played move of ply from the search of the following
+    // position (next, NULL if it was not searched) or, when the two searches cannot
+    // be combined, with a direct search on engine
+    void chainPly(StockfishEngine& engine, const Game& game, size_t ply, int depth,
+                  PlyResult& result, const PlyResult* next);
+
+    // Evaluate the played move against the engine's top moves, print it and store the analysis
+    void reportPly(Game& game, int gameIndex, size_t ply, const PlyResult& result,
+                   std::ostream& out, bool liveOutput);
+
+    // Pull the next selected game from the stream; gameIndex is its 1-based
+    // position in the file. False at the end of the stream or past the last
+    // selected game.
+    bool nextGame(PgnParser& parser, const std::set<int>& selectedGames, Game& game, int& gameIndex);
+
+    // Pre-pass over a second stream of the input, up to the last selected game:
+    // count the plies to analyze and register their positions in the memo (with
+    // dedup); totalGames is set if the whole input was read
+    bool findSharedPositions(const std::set<int>& selectedGames);
+
+    // Release the positions registered for an analyzed game, so the memo can
+    // free results no later game needs
+    void releasePositions(const Game& game);
+
+    // Write the blunder listing lines of an analyzed game; returns the number of blunders
+    int formatBlunders(const Game& game, int gameIndex, std::ostream& out) const;
+
+    // Add an analyzed game to the summary (called in game order)
+    void recordGame(int blunders, const std::string& listing);
 
-    void analyzeGame(Game& game, int gameIndex);
+    // Run the selected games on all pooled engines, printing each game's output in game order
+    void analyzeGamesParallel(PgnParser& parser, const std::set<int>& selectedGames);
 };
 
 #endif // BLUNDER_ANALYZER_H
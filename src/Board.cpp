@@ -4,12 +4,190 @@
 #include <cstdlib>
 #include <iostream>
 
+namespace {
+
+// Attack and key tables, filled once at startup
+struct BoardTables {
+    Bitboard knightAttacks[64];
+    Bitboard kingAttacks[64];
+    Bitboard pawnAttacks[2][64];  // [color][square]: squares a pawn on square attacks
+    Bitboard rays[8][64];         // Sliding rays without the origin square
+    int castleMask[64];           // Castling rights kept when a move touches the square
+
+    uint64_t pieceKeys[13][64];
+    uint64_t castleKeys[16];
+    uint64_t enPassantKeys[8];
+    uint64_t sideKey;
+
+    BoardTables();
+};
+
+// Ray directions: the first four step towards higher squares, the others towards lower ones
+const int RAY_FILE_STEP[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+const int RAY_RANK_STEP[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+const int RAY_N = 0, RAY_NE = 1, RAY_E = 2, RAY_NW = 7;
+const int RAY_SE = 3, RAY_S = 4, RAY_SW = 5, RAY_W = 6;
+
+// Fixed-seed generator so that hashes are identical across runs
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+Bitboard squareBB(int square) {
+    return 1ULL << square;
+}
+
+// Bitboard of the square at (file, rank), 0 if off the board
+Bitboard squareAt(int file, int rank) {
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+        return 0;
+    }
+    return squareBB(rank * 8 + file);
+}
+
+BoardTables::BoardTables() {
+    static const int knightSteps[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+
+    for (int square = 0; square < 64; square++) {
+        int file = square % 8;
+        int rank = square / 8;
+
+        knightAttacks[square] = 0;
+        kingAttacks[square] = 0;
+        for (int i = 0; i < 8; i++) {
+            knightAttacks[square] |= squareAt(file + knightSteps[i][0], rank + knightSteps[i][1]);
+            kingAttacks[square] |= squareAt(file + RAY_FILE_STEP[i], rank + RAY_RANK_STEP[i]);
+        }
+
+        pawnAttacks[0][square] = squareAt(file - 1, rank + 1) | squareAt(file + 1, rank + 1);
+        pawnAttacks[1][square] = squareAt(file - 1, rank - 1) | squareAt(file + 1, rank - 1);
+
+        for (int dir = 0; dir < 8; dir++) {
+            rays[dir][square] = 0;
+            for (int f = file + RAY_FILE_STEP[dir], r = rank + RAY_RANK_STEP[dir];
+                 f >= 0 && f < 8 && r >= 0 && r < 8;
+                 f += RAY_FILE_STEP[dir], r += RAY_RANK_STEP[dir]) {
+                rays[dir][square] |= squareBB(r * 8 + f);
+            }
+        }
+
+        castleMask[square] = CASTLE_WK | CASTLE_WQ | CASTLE_BK | CASTLE_BQ;
+    }
+
+    castleMask[0] &= ~CASTLE_WQ;
+    castleMask[7] &= ~CASTLE_WK;
+    castleMask[4] &= ~(CASTLE_WK | CASTLE_WQ);
+    castleMask[56] &= ~CASTLE_BQ;
+    castleMask[63] &= ~CASTLE_BK;
+    castleMask[60] &= ~(CASTLE_BK | CASTLE_BQ);
+
+    uint64_t seed = 0x46494E4445504154ULL;
+    for (int p = 0; p < 13; p++) {
+        for (int square = 0; square < 64; square++) {
+            pieceKeys[p][square] = (p == EMPTY) ? 0 : splitMix64(seed);
+        }
+    }
+    castleKeys[0] = 0;
+    for (int i = 1; i < 16; i++) {
+        castleKeys[i] = splitMix64(seed);
+    }
+    for (int i = 0; i < 8; i++) {
+        enPassantKeys[i] = splitMix64(seed);
+    }
+    sideKey = splitMix64(seed);
+}
+
+const BoardTables tables;
+
+int lsb(Bitboard b) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(b);
+#else
+    int index = 0;
+    while (!(b & 1)) {
+        b >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+int msb(Bitboard b) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(b);
+#else
+    int index = 0;
+    while (b >>= 1) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+// Ray attacks up to and including the first blocker
+Bitboard rayAttacks(int dir, int square, Bitboard occupied) {
+    Bitboard attacks = tables.rays[dir][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers) {
+        int blocker = (dir == RAY_N || dir == RAY_NE || dir == RAY_E || dir == RAY_NW) ? lsb(blockers) : msb(blockers);
+        attacks ^= tables.rays[dir][blocker];
+    }
+    return attacks;
+}
+
+Bitboard bishopAttacks(int square, Bitboard occupied) {
+    return rayAttacks(RAY_NE, square, occupied) | rayAttacks(RAY_NW, square, occupied) |
+           rayAttacks(RAY_SE, square, occupied) | rayAttacks(RAY_SW, square, occupied);
+}
+
+Bitboard rookAttacks(int square, Bitboard occupied) {
+    return rayAttacks(RAY_N, square, occupied) | rayAttacks(RAY_S, square, occupied) |
+           rayAttacks(RAY_E, square, occupied) | rayAttacks(RAY_W, square, occupied);
+}
+
+// Piece of the given type (WHITE_* value) for a color
+Piece colored(Piece whitePiece, bool white) {
+    return white ? whitePiece : static_cast<Piece>(whitePiece + 6);
+}
+
+Piece promotionPiece(char promotion, bool white) {
+    switch (tolower(promotion)) {
+        case 'r': return colored(WHITE_ROOK, white);
+        case 'b': return colored(WHITE_BISHOP, white);
+        case 'n': return colored(WHITE_KNIGHT, white);
+        default: return colored(WHITE_QUEEN, white);
+    }
+}
+
+void addPawnMove(std::vector<Move>& moves, int from, int to) {
+    if (to >= 56 || to < 8) {
+        moves.push_back(Move(from, to, 'q'));
+        moves.push_back(Move(from, to, 'r'));
+        moves.push_back(Move(from, to, 'b'));
+        moves.push_back(Move(from, to, 'n'));
+    } else {
+        moves.push_back(Move(from, to));
+    }
+}
+
+} // namespace
+
 Board::Board()
     : whiteToMove(true)
     , castlingRights(0)
     , enPassantSquare(-1)
     , halfMoveClock(0)
     , fullMoveNumber(1)
+    , hash(0)
 {
     setStartingPosition();
 }
@@ -18,34 +196,32 @@ void Board::clearBoard() {
     for (int i = 0; i < 64; i++) {
         board[i] = EMPTY;
     }
+    for (int p = 0; p < 13; p++) {
+        pieces[p] = 0;
+    }
+    colors[0] = 0;
+    colors[1] = 0;
+    hash = 0;
+    moveHistory.clear();
 }
 
 void Board::setStartingPosition() {
-    clearBoard();
-
-    // White pieces
-    board[0] = WHITE_ROOK;   board[1] = WHITE_KNIGHT;
-    board[2] = WHITE_BISHOP; board[3] = WHITE_QUEEN;
-    board[4] = WHITE_KING;   board[5] = WHITE_BISHOP;
-    board[6] = WHITE_KNIGHT; board[7] = WHITE_ROOK;
-    for (int i = 8; i < 16; i++) {
-        board[i] = WHITE_PAWN;
-    }
+    setFromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
 
-    // Black pieces
-    for (int i = 48; i < 56; i++) {
-        board[i] = BLACK_PAWN;
-    }
-    board[56] = BLACK_ROOK;   board[57] = BLACK_KNIGHT;
-    board[58] = BLACK_BISHOP; board[59] = BLACK_QUEEN;
-    board[60] = BLACK_KING;   board[61] = BLACK_BISHOP;
-    board[62] = BLACK_KNIGHT; board[63] = BLACK_ROOK;
+void Board::putPiece(Piece p, int square) {
+    board[square] = p;
+    pieces[p] |= squareBB(square);
+    colors[isWhitePiece(p) ? 0 : 1] |= squareBB(square);
+    hash ^= tables.pieceKeys[p][square];
+}
 
-    whiteToMove = true;
-    castlingRights = CASTLE_WK | CASTLE_WQ | CASTLE_BK | CASTLE_BQ;
-    enPassantSquare = -1;
-    halfMoveClock = 0;
-    fullMoveNumber = 1;
+void Board::removePiece(int square) {
+    Piece p = board[square];
+    board[square] = EMPTY;
+    pieces[p] &= ~squareBB(square);
+    colors[isWhitePiece(p) ? 0 : 1] &= ~squareBB(square);
+    hash ^= tables.pieceKeys[p][square];
 }
 
 void Board::setFromFen(const std::string& fen) {
@@ -64,8 +240,8 @@ void Board::setFromFen(const std::string& fen) {
             square -= 16; // Go to next rank down
         } else if (isdigit(c)) {
             square += (c - '0'); // Skip empty squares
-        } else {
-            board[square] = charToPiece(c);
+        } else if (square >= 0 && square < 64 && charToPiece(c) != EMPTY) {
+            putPiece(charToPiece(c), square);
             square++;
         }
     }
@@ -73,7 +249,7 @@ void Board::setFromFen(const std::string& fen) {
     // Parse active color
     std::string color;
     iss >> color;
-    whiteToMove = (color == "w");
+    whiteToMove = (color != "b");
 
     // Parse castling rights
     std::string castling;
@@ -87,19 +263,20 @@ void Board::setFromFen(const std::string& fen) {
     // Parse en passant square
     std::string epSquare;
     iss >> epSquare;
-    if (epSquare == "-") {
-        enPassantSquare = -1;
-    } else {
+    enPassantSquare = -1;
+    if (epSquare.length() == 2 && epSquare[0] >= 'a' && epSquare[0] <= 'h' && epSquare[1] >= '1' && epSquare[1] <= '8') {
         int file = epSquare[0] - 'a';
         int rank = epSquare[1] - '1';
         enPassantSquare = rank * 8 + file;
     }
 
-    // Parse halfmove clock
+    // Parse halfmove clock and fullmove number (optional in abbreviated FENs)
+    halfMoveClock = 0;
+    fullMoveNumber = 1;
     iss >> halfMoveClock;
-
-    // Parse fullmove number
     iss >> fullMoveNumber;
+
+    hash = computeHash();
 }
 
 std::string Board::toFen() const {
@@ -181,90 +358,92 @@ std::string Board::toFen() const {
     return oss.str();
 }
 
+uint64_t Board::enPassantKey() const {
+    if (enPassantSquare == -1) {
+        return 0;
+    }
+    // A pawn of the side to move attacks the square if a pawn of the other
+    // color standing there would attack it
+    Bitboard capturers = tables.pawnAttacks[whiteToMove ? 1 : 0][enPassantSquare] &
+                         pieces[colored(WHITE_PAWN, whiteToMove)];
+    return capturers ? tables.enPassantKeys[enPassantSquare % 8] : 0;
+}
+
+uint64_t Board::computeHash() const {
+    uint64_t key = 0;
+    for (int square = 0; square < 64; square++) {
+        key ^= tables.pieceKeys[board[square]][square];
+    }
+    key ^= tables.castleKeys[castlingRights];
+    key ^= enPassantKey();
+    if (!whiteToMove) {
+        key ^= tables.sideKey;
+    }
+    return key;
+}
+
 bool Board::makeMove(const Move& move) {
     if (!move.isValid()) {
         return false;
     }
 
-    // Basic legality check can be added here
-    // For now, we assume PGN moves are legal
-
     Piece movingPiece = board[move.fromSquare];
-    Piece capturedPiece = board[move.toSquare];
+    if (movingPiece == EMPTY || isWhitePiece(movingPiece) != whiteToMove) {
+        return false;
+    }
+
+    bool isPawn = (movingPiece == WHITE_PAWN || movingPiece == BLACK_PAWN);
+    bool isKing = (movingPiece == WHITE_KING || movingPiece == BLACK_KING);
 
     // Save move for unmake
     MoveRecord record;
     record.move = move;
-    record.capturedPiece = capturedPiece;
+    record.movedPiece = movingPiece;
+    record.capturedSquare = move.toSquare;
+    if (isPawn && move.toSquare == enPassantSquare) {
+        record.capturedSquare = whiteToMove ? (enPassantSquare - 8) : (enPassantSquare + 8);
+    }
+    record.capturedPiece = board[record.capturedSquare];
     record.oldCastlingRights = castlingRights;
     record.oldEnPassantSquare = enPassantSquare;
     record.oldHalfMoveClock = halfMoveClock;
+    record.oldHash = hash;
     moveHistory.push_back(record);
 
-    // Execute move
-    board[move.toSquare] = movingPiece;
-    board[move.fromSquare] = EMPTY;
-
-    // Handle promotion
-    if (move.isPromotion()) {
-        if (whiteToMove) {
-            switch (move.promotion) {
-                case 'q': board[move.toSquare] = WHITE_QUEEN; break;
-                case 'r': board[move.toSquare] = WHITE_ROOK; break;
-                case 'b': board[move.toSquare] = WHITE_BISHOP; break;
-                case 'n': board[move.toSquare] = WHITE_KNIGHT; break;
-            }
-        } else {
-            switch (move.promotion) {
-                case 'q': board[move.toSquare] = BLACK_QUEEN; break;
-                case 'r': board[move.toSquare] = BLACK_ROOK; break;
-                case 'b': board[move.toSquare] = BLACK_BISHOP; break;
-                case 'n': board[move.toSquare] = BLACK_KNIGHT; break;
-            }
-        }
-    }
+    // Remove the state keys that may change; the piece keys are updated by put/remove
+    hash ^= enPassantKey();
+    hash ^= tables.castleKeys[castlingRights];
 
-    // Handle en passant capture
-    if (enPassantSquare != -1 && move.toSquare == enPassantSquare) {
-        if (movingPiece == WHITE_PAWN || movingPiece == BLACK_PAWN) {
-            // Capture the pawn
-            int capturedPawnSquare = whiteToMove ? (enPassantSquare - 8) : (enPassantSquare + 8);
-            board[capturedPawnSquare] = EMPTY;
-        }
+    // Execute move (captures include en passant)
+    if (record.capturedPiece != EMPTY) {
+        removePiece(record.capturedSquare);
     }
-
-    // Handle castling
-    if (movingPiece == WHITE_KING && move.fromSquare == 4) {
-        if (move.toSquare == 6) { // Kingside castle
-            board[5] = WHITE_ROOK;
-            board[7] = EMPTY;
-        } else if (move.toSquare == 2) { // Queenside castle
-            board[3] = WHITE_ROOK;
-            board[0] = EMPTY;
-        }
-    } else if (movingPiece == BLACK_KING && move.fromSquare == 60) {
-        if (move.toSquare == 62) { // Kingside castle
-            board[61] = BLACK_ROOK;
-            board[63] = EMPTY;
-        } else if (move.toSquare == 58) { // Queenside castle
-            board[59] = BLACK_ROOK;
-            board[56] = EMPTY;
+    removePiece(move.fromSquare);
+    putPiece(move.isPromotion() ? promotionPiece(move.promotion, whiteToMove) : movingPiece, move.toSquare);
+
+    // Handle castling (the king moves two files, the rook jumps over it)
+    if (isKing && abs(move.toSquare - move.fromSquare) == 2) {
+        int rookFrom = (move.toSquare > move.fromSquare) ? move.fromSquare + 3 : move.fromSquare - 4;
+        int rookTo = (move.fromSquare + move.toSquare) / 2;
+        if (board[rookFrom] != EMPTY) {
+            Piece rook = board[rookFrom];
+            removePiece(rookFrom);
+            putPiece(rook, rookTo);
         }
     }
 
     // Update castling rights
     updateCastlingRights(move);
+    hash ^= tables.castleKeys[castlingRights];
 
     // Update en passant square
     enPassantSquare = -1;
-    if (movingPiece == WHITE_PAWN && move.fromSquare / 8 == 1 && move.toSquare / 8 == 3) {
-        enPassantSquare = move.fromSquare + 8;
-    } else if (movingPiece == BLACK_PAWN && move.fromSquare / 8 == 6 && move.toSquare / 8 == 4) {
-        enPassantSquare = move.fromSquare - 8;
+    if (isPawn && abs(move.toSquare - move.fromSquare) == 16) {
+        enPassantSquare = (move.fromSquare + move.toSquare) / 2;
     }
 
     // Update halfmove clock
-    if (movingPiece == WHITE_PAWN || movingPiece == BLACK_PAWN || capturedPiece != EMPTY) {
+    if (isPawn || record.capturedPiece != EMPTY) {
         halfMoveClock = 0;
     } else {
         halfMoveClock++;
@@ -275,8 +454,10 @@ bool Board::makeMove(const Move& move) {
         fullMoveNumber++;
     }
 
-    // Switch side to move
+    // Switch side to move (the en passant key depends on the new side to move)
     whiteToMove = !whiteToMove;
+    hash ^= tables.sideKey;
+    hash ^= enPassantKey();
 
     return true;
 }
@@ -292,38 +473,31 @@ void Board::unmakeMove() {
     // Restore position
     whiteToMove = !whiteToMove;
 
-    Piece movingPiece = board[record.move.toSquare];
-    board[record.move.fromSquare] = movingPiece;
-    board[record.move.toSquare] = record.capturedPiece;
+    // Undo castling
+    Piece movingPiece = record.movedPiece;
+    if ((movingPiece == WHITE_KING || movingPiece == BLACK_KING) &&
+        abs(record.move.toSquare - record.move.fromSquare) == 2) {
+        int rookFrom = (record.move.toSquare > record.move.fromSquare) ? record.move.fromSquare + 3 : record.move.fromSquare - 4;
+        int rookTo = (record.move.fromSquare + record.move.toSquare) / 2;
+        if (board[rookTo] != EMPTY) {
+            Piece rook = board[rookTo];
+            removePiece(rookTo);
+            putPiece(rook, rookFrom);
+        }
+    }
 
-    // Undo promotion
-    if (record.move.isPromotion()) {
-        board[record.move.fromSquare] = whiteToMove ? WHITE_PAWN : BLACK_PAWN;
+    // Move the piece back (undoing a promotion) and restore a captured piece
+    removePiece(record.move.toSquare);
+    putPiece(movingPiece, record.move.fromSquare);
+    if (record.capturedPiece != EMPTY) {
+        putPiece(record.capturedPiece, record.capturedSquare);
     }
 
     // Restore castling rights
     castlingRights = record.oldCastlingRights;
     enPassantSquare = record.oldEnPassantSquare;
     halfMoveClock = record.oldHalfMoveClock;
-
-    // Undo castling
-    if (movingPiece == WHITE_KING && record.move.fromSquare == 4) {
-        if (record.move.toSquare == 6) {
-            board[7] = WHITE_ROOK;
-            board[5] = EMPTY;
-        } else if (record.move.toSquare == 2) {
-            board[0] = WHITE_ROOK;
-            board[3] = EMPTY;
-        }
-    } else if (movingPiece == BLACK_KING && record.move.fromSquare == 60) {
-        if (record.move.toSquare == 62) {
-            board[63] = BLACK_ROOK;
-            board[61] = EMPTY;
-        } else if (record.move.toSquare == 58) {
-            board[56] = BLACK_ROOK;
-            board[59] = EMPTY;
-        }
-    }
+    hash = record.oldHash;
 
     // Restore fullmove number
     if (!whiteToMove) {
@@ -332,30 +506,124 @@ void Board::unmakeMove() {
 }
 
 void Board::updateCastlingRights(const Move& move) {
-    // Remove castling rights if king or rook moves
-    if (board[move.fromSquare] == WHITE_KING) {
-        castlingRights &= ~(CASTLE_WK | CASTLE_WQ);
-    } else if (board[move.fromSquare] == BLACK_KING) {
-        castlingRights &= ~(CASTLE_BK | CASTLE_BQ);
+    // Remove castling rights if the king or a rook moves from (or a rook is
+    // captured on) its starting square
+    castlingRights &= tables.castleMask[move.fromSquare] & tables.castleMask[move.toSquare];
+}
+
+bool Board::isMoveLegal(const Move& move) const {
+    if (!move.isValid()) {
+        return false;
+    }
+
+    std::vector<Move> legalMoves;
+    generateLegalMoves(legalMoves);
+    for (size_t i = 0; i < legalMoves.size(); i++) {
+        if (legalMoves[i].fromSquare == move.fromSquare && legalMoves[i].toSquare == move.toSquare &&
+            legalMoves[i].promotion == tolower(move.promotion)) {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Remove castling rights if rook moves from starting square
-    if (move.fromSquare == 0) castlingRights &= ~CASTLE_WQ;
-    if (move.fromSquare == 7) castlingRights &= ~CASTLE_WK;
-    if (move.fromSquare == 56) castlingRights &= ~CASTLE_BQ;
-    if (move.fromSquare == 63) castlingRights &= ~CASTLE_BK;
+void Board::generateLegalMoves(std::vector<Move>& moves) const {
+    size_t first = moves.size();
+    generatePseudoLegalMoves(moves);
 
-    // Remove castling rights if rook is captured
-    if (move.toSquare == 0) castlingRights &= ~CASTLE_WQ;
-    if (move.toSquare == 7) castlingRights &= ~CASTLE_WK;
-    if (move.toSquare == 56) castlingRights &= ~CASTLE_BQ;
-    if (move.toSquare == 63) castlingRights &= ~CASTLE_BK;
+    // Drop moves that leave the own king in check
+    size_t kept = first;
+    for (size_t i = first; i < moves.size(); i++) {
+        if (!wouldBeInCheck(moves[i], whiteToMove)) {
+            moves[kept++] = moves[i];
+        }
+    }
+    moves.resize(kept);
 }
 
-bool Board::isMoveLegal(const Move& move) const {
-    // Simplified legality check
-    // For this application, we trust PGN moves are legal
-    return move.isValid();
+void Board::generatePseudoLegalMoves(std::vector<Move>& moves) const {
+    int us = whiteToMove ? 0 : 1;
+    Bitboard own = colors[us];
+    Bitboard enemy = colors[1 - us];
+    Bitboard occupied = own | enemy;
+    Bitboard empty = ~occupied;
+
+    // Pawns: pushes, double pushes, captures (en passant included), promotions
+    Bitboard pawns = pieces[colored(WHITE_PAWN, whiteToMove)];
+    int forward = whiteToMove ? 8 : -8;
+    int startRank = whiteToMove ? 1 : 6;
+    Bitboard epTarget = (enPassantSquare != -1) ? squareBB(enPassantSquare) : 0;
+    while (pawns) {
+        int from = popLsb(pawns);
+        int to = from + forward;
+        if (empty & squareBB(to)) {
+            addPawnMove(moves, from, to);
+            if (from / 8 == startRank && (empty & squareBB(to + forward))) {
+                moves.push_back(Move(from, to + forward));
+            }
+        }
+        Bitboard captures = tables.pawnAttacks[us][from] & (enemy | epTarget);
+        while (captures) {
+            addPawnMove(moves, from, popLsb(captures));
+        }
+    }
+
+    // Pieces
+    for (int type = WHITE_KNIGHT; type <= WHITE_KING; type++) {
+        Bitboard movers = pieces[colored(static_cast<Piece>(type), whiteToMove)];
+        while (movers) {
+            int from = popLsb(movers);
+            Bitboard targets;
+            switch (type) {
+                case WHITE_KNIGHT: targets = tables.knightAttacks[from]; break;
+                case WHITE_BISHOP: targets = bishopAttacks(from, occupied); break;
+                case WHITE_ROOK: targets = rookAttacks(from, occupied); break;
+                case WHITE_QUEEN: targets = bishopAttacks(from, occupied) | rookAttacks(from, occupied); break;
+                default: targets = tables.kingAttacks[from]; break;
+            }
+            targets &= ~own;
+            while (targets) {
+                moves.push_back(Move(from, popLsb(targets)));
+            }
+        }
+    }
+
+    // Castling: king and rook on their squares, the squares between empty and
+    // the king neither in check nor passing an attacked square (the destination
+    // square is checked by the legality filter)
+    int kingSquare = whiteToMove ? 4 : 60;
+    Piece king = colored(WHITE_KING, whiteToMove);
+    Piece rook = colored(WHITE_ROOK, whiteToMove);
+    int kingside = whiteToMove ? CASTLE_WK : CASTLE_BK;
+    int queenside = whiteToMove ? CASTLE_WQ : CASTLE_BQ;
+    if (board[kingSquare] == king && (castlingRights & (kingside | queenside)) && !isInCheck(whiteToMove)) {
+        if ((castlingRights & kingside) && board[kingSquare + 3] == rook &&
+            board[kingSquare + 1] == EMPTY && board[kingSquare + 2] == EMPTY &&
+            !isSquareAttacked(kingSquare + 1, !whiteToMove)) {
+            moves.push_back(Move(kingSquare, kingSquare + 2));
+        }
+        if ((castlingRights & queenside) && board[kingSquare - 4] == rook &&
+            board[kingSquare - 1] == EMPTY && board[kingSquare - 2] == EMPTY && board[kingSquare - 3] == EMPTY &&
+            !isSquareAttacked(kingSquare - 1, !whiteToMove)) {
+            moves.push_back(Move(kingSquare, kingSquare - 2));
+        }
+    }
+}
+
+uint64_t Board::perft(int depth) {
+    std::vector<Move> moves;
+    generateLegalMoves(moves);
+    if (depth <= 1) {
+        return depth == 1 ? moves.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < moves.size(); i++) {
+        makeMove(moves[i]);
+        nodes += perft(depth - 1);
+        unmakeMove();
+    }
+    return nodes;
 }
 
 Piece Board::getPieceAt(int square) const {
@@ -409,18 +677,44 @@ Piece Board::charToPiece(char c) {
     }
 }
 
+Bitboard Board::attackersTo(int square, bool byWhite, Bitboard occupied) const {
+    Bitboard bishopsQueens = pieces[colored(WHITE_BISHOP, byWhite)] | pieces[colored(WHITE_QUEEN, byWhite)];
+    Bitboard rooksQueens = pieces[colored(WHITE_ROOK, byWhite)] | pieces[colored(WHITE_QUEEN, byWhite)];
+
+    // A pawn of the attacking color attacks square if a pawn of the defending
+    // color on square would attack the pawn
+    return (tables.pawnAttacks[byWhite ? 1 : 0][square] & pieces[colored(WHITE_PAWN, byWhite)]) |
+           (tables.knightAttacks[square] & pieces[colored(WHITE_KNIGHT, byWhite)]) |
+           (tables.kingAttacks[square] & pieces[colored(WHITE_KING, byWhite)]) |
+           (bishopAttacks(square, occupied) & bishopsQueens) |
+           (rookAttacks(square, occupied) & rooksQueens);
+}
+
 bool Board::isSquareAttacked(int square, bool byWhite) const {
-    // Simplified - not fully implemented for this application
-    // Would need full attack generation
-    return false;
+    return attackersTo(square, byWhite, colors[0] | colors[1]) != 0;
 }
 
 bool Board::isInCheck(bool white) const {
-    // Simplified - not fully implemented for this application
-    return false;
+    Bitboard king = pieces[colored(WHITE_KING, white)];
+    return king && isSquareAttacked(lsb(king), !white);
 }
 
 bool Board::wouldBeInCheck(const Move& move, bool white) const {
-    // Simplified - not fully implemented for this application
-    return false;
+    Piece movingPiece = board[move.fromSquare];
+    bool isPawn = (movingPiece == WHITE_PAWN || movingPiece == BLACK_PAWN);
+
+    // Occupancy after the move; a captured piece no longer attacks
+    int capturedSquare = move.toSquare;
+    if (isPawn && move.toSquare == enPassantSquare) {
+        capturedSquare = white ? (enPassantSquare - 8) : (enPassantSquare + 8);
+    }
+    Bitboard captured = squareBB(capturedSquare);
+    Bitboard occupied = ((colors[0] | colors[1]) & ~squareBB(move.fromSquare) & ~captured) | squareBB(move.toSquare);
+
+    Bitboard king = pieces[colored(WHITE_KING, white)];
+    if (!king) {
+        return false;
+    }
+    int kingSquare = (movingPiece == colored(WHITE_KING, white)) ? move.toSquare : lsb(king);
+    return (attackersTo(kingSquare, !white, occupied) & ~captured) != 0;
 }
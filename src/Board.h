@@ -2,6 +2,7 @@
 #define BOARD_H
 
 #include "Move.h"
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,9 @@ const int CASTLE_WQ = 2;  // White queenside
 const int CASTLE_BK = 4;  // Black kingside
 const int CASTLE_BQ = 8;  // Black queenside
 
+// One bit per square (a1 = bit 0, h8 = bit 63)
+typedef uint64_t Bitboard;
+
 class Board {
 public:
     Board();
@@ -35,13 +39,39 @@ public:
     void setFromFen(const std::string& fen);
     std::string toFen() const;
 
+    // Play a move given in UCI terms (castling as a two-square king move,
+    // promotion piece in either case). Returns false and leaves the position
+    // unchanged if no piece of the side to move stands on the from square;
+    // the move is otherwise trusted to be legal (see isMoveLegal()).
     bool makeMove(const Move& move);
     void unmakeMove();  // Undo last move
 
     bool isMoveLegal(const Move& move) const;
 
+    // All legal moves of the side to move (appended to moves)
+    void generateLegalMoves(std::vector<Move>& moves) const;
+
+    // Moves that obey piece movement rules but may leave the own king in check,
+    // and the check that filters them (cheaper when only a few candidates matter)
+    void generatePseudoLegalMoves(std::vector<Move>& moves) const;
+    bool isLegal(const Move& pseudoLegalMove) const { return !wouldBeInCheck(pseudoLegalMove, whiteToMove); }
+
+    // Number of leaf nodes of the legal move tree to the given depth
+    uint64_t perft(int depth);
+
     Piece getPieceAt(int square) const;
     bool isWhiteToMove() const { return whiteToMove; }
+    bool isInCheck() const { return isInCheck(whiteToMove); }
+    int getHalfMoveClock() const { return halfMoveClock; }
+    int getFullMoveNumber() const { return fullMoveNumber; }
+
+    // Zobrist key of the position (pieces, side to move, castling rights and an
+    // en passant square that can actually be captured on), updated incrementally
+    // by makeMove()/unmakeMove(). Keys are fixed, so hashes are stable across runs.
+    uint64_t getHash() const { return hash; }
+
+    // Zobrist key computed from scratch (to verify the incremental key)
+    uint64_t computeHash() const;
 
     // Helper functions
     static bool isWhitePiece(Piece p);
@@ -50,7 +80,10 @@ public:
     static Piece charToPiece(char c);
 
 private:
-    // Mailbox representation (0-63)
+    // Bitboards per piece (indexed by Piece, EMPTY unused) and per color
+    // (0 = white, 1 = black); the mailbox is kept alongside for piece lookup
+    Bitboard pieces[13];
+    Bitboard colors[2];
     Piece board[64];
 
     // Game state
@@ -59,14 +92,18 @@ private:
     int enPassantSquare; // -1 if none
     int halfMoveClock;
     int fullMoveNumber;
+    uint64_t hash;
 
     // Move history for unmake
     struct MoveRecord {
         Move move;
+        Piece movedPiece;
         Piece capturedPiece;
+        int capturedSquare;  // Differs from move.toSquare for en passant
         int oldCastlingRights;
         int oldEnPassantSquare;
         int oldHalfMoveClock;
+        uint64_t oldHash;
     };
     std::vector<MoveRecord> moveHistory;
 
@@ -74,10 +111,21 @@ private:
     void clearBoard();
     void setStartingPosition();
 
+    // Place/remove a piece, keeping bitboards, mailbox and hash in sync
+    void putPiece(Piece p, int square);
+    void removePiece(int square);
+
+    // Zobrist contribution of the en passant square (0 unless a pawn of the
+    // side to move could capture there)
+    uint64_t enPassantKey() const;
+
     bool isSquareAttacked(int square, bool byWhite) const;
     bool isInCheck(bool white) const;
     bool wouldBeInCheck(const Move& move, bool white) const;
 
+    // Pieces of the given color attacking square with the given occupancy
+    Bitboard attackersTo(int square, bool byWhite, Bitboard occupied) const;
+
     void updateCastlingRights(const Move& move);
 };
 
@@ -0,0 +1,122 @@
+#include "ByteScan.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BYTESCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char* findScalar(const char* p, const char* end, char c) {
+    while (p < end && *p != c) {
+        p++;
+    }
+    return p;
+}
+
+#if defined(BYTESCAN_X86) && defined(__SSE2__)
+const char* findSse2(const char* p, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findScalar(p, end, c);
+}
+#define BYTESCAN_SSE2 1
+#endif
+
+#if defined(BYTESCAN_X86)
+// Compiled for AVX2 regardless of the build flags; only called after the
+// CPU check in isSupported()
+__attribute__((target("avx2")))
+const char* findAvx2(const char* p, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findScalar(p, end, c);
+}
+#endif
+
+// SSE2 is preferred over AVX2: PGN delimiters are rarely more than a few
+// dozen bytes apart, and on such short scans the 32-byte loop measured slower
+// (pgn_parser_bench). AVX2 is used where SSE2 is not compiled in.
+ByteScan::Level detectLevel() {
+    if (ByteScan::isSupported(ByteScan::SSE2)) {
+        return ByteScan::SSE2;
+    }
+    if (ByteScan::isSupported(ByteScan::AVX2)) {
+        return ByteScan::AVX2;
+    }
+    return ByteScan::SCALAR;
+}
+
+ByteScan::Level currentLevel = detectLevel();
+
+} // namespace
+
+const char* ByteScan::find(const char* begin, const char* end, char c) {
+    switch (currentLevel) {
+#if defined(BYTESCAN_X86)
+    case AVX2:
+        return findAvx2(begin, end, c);
+#endif
+#if defined(BYTESCAN_SSE2)
+    case SSE2:
+        return findSse2(begin, end, c);
+#endif
+    default:
+        return findScalar(begin, end, c);
+    }
+}
+
+ByteScan::Level ByteScan::getLevel() {
+    return currentLevel;
+}
+
+bool ByteScan::setLevel(Level level) {
+    if (!isSupported(level)) {
+        return false;
+    }
+    currentLevel = level;
+    return true;
+}
+
+bool ByteScan::isSupported(Level level) {
+    switch (level) {
+    case SCALAR:
+        return true;
+    case SSE2:
+#if defined(BYTESCAN_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    case AVX2:
+#if defined(BYTESCAN_X86)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* ByteScan::levelName(Level level) {
+    switch (level) {
+    case SSE2:
+        return "SSE2";
+    case AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
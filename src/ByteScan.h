@@ -0,0 +1,28 @@
+#ifndef BYTE_SCAN_H
+#define BYTE_SCAN_H
+
+#include <stddef.h>
+
+// Search for delimiter bytes (line breaks, braces, quotes) 16 or 32 bytes at
+// a time with SSE2 or AVX2 on x86, otherwise with a plain byte loop. The level
+// is picked at startup (see detectLevel()); all levels return the same results.
+class ByteScan {
+public:
+    enum Level {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // First occurrence of c in [begin, end), end if there is none
+    static const char* find(const char* begin, const char* end, char c);
+
+    // Level in use; setLevel() fails for levels the CPU or build lacks
+    // (benchmarks use it to compare the implementations)
+    static Level getLevel();
+    static bool setLevel(Level level);
+    static bool isSupported(Level level);
+    static const char* levelName(Level level);
+};
+
+#endif // BYTE_SCAN_H
@@ -6,15 +6,53 @@
 #include <set>
 #include <thread>
 
+// Seconds in "90", "90s", "30m" or "2h"; -1 if the text is not a duration
+static double parseDuration(const std::string& text) {
+    char* end = NULL;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0.0) {
+        return -1.0;
+    }
+    std::string unit(end);
+    if (unit.empty() || unit == "s") {
+        return value;
+    }
+    if (unit == "m") {
+        return value * 60.0;
+    }
+    if (unit == "h") {
+        return value * 3600.0;
+    }
+    return -1.0;
+}
+
 Config::Config()
     : startMoveNumber(1)
     , stockfishDepth(15)
     , thresholdCP(150)
     , threads(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1)
     , multiPV(200)
+    , engines(1)
+    , plyParallel(false)
+    , hashMB(0)
+    , hashBudgetMB(0)
+    , hashClear("never")
+    , backward(false)
+    , analysisMode("multipv")
+    , multiPVLadder("4,16,64")
+    , triageDepth(0)
+    , triageFraction(0.5)
+    , earlyStop(0)
+    , nodes(0)
+    , moveTime(0)
+    , timeBudget(0.0)
     , stockfishPath("stockfish")
-    , pgnExtractPath("pgn-extract")
     , inputPgnFile("")
+    , parseThreads(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1)
+    , positionMode("fen")
+    , dedupPositions(false)
+    , cacheFile("")
+    , cacheSizeMB(256)
     , gameSelection("")
     , debugMode(false)
     , blundersOnly(false)
@@ -57,11 +95,65 @@ void Config::loadFromCommandLine(int argc, char** argv) {
         else if (arg == "--multipv" && i + 1 < argc) {
             multiPV = atoi(argv[++i]);
         }
+        else if (arg == "--engines" && i + 1 < argc) {
+            engines = atoi(argv[++i]);
+        }
+        else if (arg == "--ply-parallel") {
+            plyParallel = true;
+        }
+        else if (arg == "--hash" && i + 1 < argc) {
+            hashMB = atoi(argv[++i]);
+        }
+        else if (arg == "--hash-budget" && i + 1 < argc) {
+            hashBudgetMB = atoi(argv[++i]);
+        }
+        else if (arg == "--hash-clear" && i + 1 < argc) {
+            hashClear = argv[++i];
+        }
+        else if (arg == "--backward") {
+            backward = true;
+        }
+        else if (arg == "--mode" && i + 1 < argc) {
+            analysisMode = argv[++i];
+        }
+        else if (arg == "--multipv-ladder" && i + 1 < argc) {
+            multiPVLadder = argv[++i];
+        }
+        else if (arg == "--triage-depth" && i + 1 < argc) {
+            triageDepth = atoi(argv[++i]);
+        }
+        else if (arg == "--triage-fraction" && i + 1 < argc) {
+            triageFraction = atof(argv[++i]);
+        }
+        else if (arg == "--early-stop" && i + 1 < argc) {
+            earlyStop = atoi(argv[++i]);
+        }
+        else if (arg == "--nodes" && i + 1 < argc) {
+            nodes = atoll(argv[++i]);
+        }
+        else if (arg == "--movetime" && i + 1 < argc) {
+            moveTime = atoi(argv[++i]);
+        }
+        else if (arg == "--time-budget" && i + 1 < argc) {
+            timeBudget = parseDuration(argv[++i]);
+        }
         else if (arg == "--stockfish" && i + 1 < argc) {
             stockfishPath = argv[++i];
         }
-        else if (arg == "--pgn-extract" && i + 1 < argc) {
-            pgnExtractPath = argv[++i];
+        else if (arg == "--parse-threads" && i + 1 < argc) {
+            parseThreads = atoi(argv[++i]);
+        }
+        else if (arg == "--position" && i + 1 < argc) {
+            positionMode = argv[++i];
+        }
+        else if (arg == "--dedup") {
+            dedupPositions = true;
+        }
+        else if (arg == "--cache" && i + 1 < argc) {
+            cacheFile = argv[++i];
+        }
+        else if (arg == "--cache-size" && i + 1 < argc) {
+            cacheSizeMB = atoi(argv[++i]);
         }
         else if (arg == "--games" && i + 1 < argc) {
             gameSelection = argv[++i];
@@ -114,6 +206,98 @@ bool Config::validate() const {
         return false;
     }
 
+    if (engines < 1 || engines > 256) {
+        std::cerr << "Error: Engines must be between 1 and 256" << std::endl;
+        return false;
+    }
+
+    // Stockfish accepts up to 32 TB of hash per process
+    if (hashMB < 0 || hashMB > 33554432) {
+        std::cerr << "Error: Hash must be between 0 and 33554432 MB (0 = Stockfish default)" << std::endl;
+        return false;
+    }
+
+    if (hashBudgetMB < 0 || hashBudgetMB > 33554432) {
+        std::cerr << "Error: Hash budget must be between 0 and 33554432 MB" << std::endl;
+        return false;
+    }
+
+    if (hashBudgetMB > 0 && hashBudgetMB < engines) {
+        std::cerr << "Error: Hash budget must give each engine at least 1 MB" << std::endl;
+        return false;
+    }
+
+    if (hashBudgetMB > 0 && hashMB > 0) {
+        std::cerr << "Error: Use either --hash or --hash-budget" << std::endl;
+        return false;
+    }
+
+    if (hashClear != "never" && hashClear != "game" && hashClearInterval() <= 0) {
+        std::cerr << "Error: Hash clear must be 'never', 'game' or a number of moves" << std::endl;
+        return false;
+    }
+
+    if (parseThreads < 1 || parseThreads > 256) {
+        std::cerr << "Error: Parse threads must be between 1 and 256" << std::endl;
+        return false;
+    }
+
+    if (analysisMode != "multipv" && analysisMode != "searchmoves" && analysisMode != "adaptive" &&
+        analysisMode != "chain") {
+        std::cerr << "Error: Mode must be 'multipv', 'searchmoves', 'adaptive' or 'chain'" << std::endl;
+        return false;
+    }
+
+    if (positionMode != "fen" && positionMode != "moves") {
+        std::cerr << "Error: Position must be 'fen' or 'moves'" << std::endl;
+        return false;
+    }
+
+    if (cacheSizeMB < 1 || cacheSizeMB > 65536) {
+        std::cerr << "Error: Cache size must be between 1 and 65536 MB" << std::endl;
+        return false;
+    }
+
+    if (triageDepth < 0 || (triageDepth > 0 && triageDepth >= stockfishDepth)) {
+        std::cerr << "Error: Triage depth must be below --depth (0 disables triage)" << std::endl;
+        return false;
+    }
+
+    if (triageFraction <= 0.0 || triageFraction > 1.0) {
+        std::cerr << "Error: Triage fraction must be greater than 0 and at most 1" << std::endl;
+        return false;
+    }
+
+    if (earlyStop < 0 || earlyStop > 64) {
+        std::cerr << "Error: Early stop must be between 0 and 64 iterations (0 disables it)" << std::endl;
+        return false;
+    }
+
+    if (earlyStop > 0 && analysisMode != "multipv" && analysisMode != "adaptive") {
+        std::cerr << "Error: Early stop needs the played move among the lines (--mode multipv or adaptive)" << std::endl;
+        return false;
+    }
+
+    if (nodes < 0) {
+        std::cerr << "Error: Nodes must not be negative (0 = no node limit)" << std::endl;
+        return false;
+    }
+
+    if (moveTime < 0) {
+        std::cerr << "Error: Movetime must not be negative (0 = no time limit)" << std::endl;
+        return false;
+    }
+
+    if (timeBudget < 0.0) {
+        std::cerr << "Error: Time budget must be a duration like 600, 90s, 30m or 2h" << std::endl;
+        return false;
+    }
+
+    if (timeBudget > 0.0 && moveTime > 0) {
+        std::cerr << "Error: Use either --movetime or --time-budget" << std::endl;
+        return false;
+    }
+
     return true;
 }
 
@@ -128,16 +312,48 @@ void Config::printUsage(const char* programName) const {
     std::cout << "  --start-move <n>      Start analysis from move number (default: 1)" << std::endl;
     std::cout << "  --threads <n>         Number of CPU threads for Stockfish (default: auto-detect)" << std::endl;
     std::cout << "  --multipv <n>         Number of top moves to analyze (default: 200)" << std::endl;
+    std::cout << "  --engines <n>         Number of Stockfish processes analyzing games in parallel (default: 1)" << std::endl;
+    std::cout << "  --ply-parallel        Spread the moves of each game across the engines (deep single-game reviews)" << std::endl;
+    std::cout << "  --hash <MB>           Stockfish hash table per engine (default: Stockfish's 16 MB)" << std::endl;
+    std::cout << "  --hash-budget <MB>    Hash for all engines together, split evenly across them (default: off)" << std::endl;
+    std::cout << "  --hash-clear <when>   Clear the hash (ucinewgame): 'never', 'game' (before each game) or" << std::endl;
+    std::cout << "                        every n moves an engine searched (default: never)" << std::endl;
+    std::cout << "  --backward            Search the moves of each game from the last to the first (hash reuse)" << std::endl;
+    std::cout << "  --mode <mode>         Played move evaluation: 'multipv' (find it among the top moves)," << std::endl;
+    std::cout << "                        'searchmoves' (best line + restricted search) or 'adaptive'" << std::endl;
+    std::cout << "                        (raise MultiPV until the played move shows up) or 'chain' (score the" << std::endl;
+    std::cout << "                        played move from the search of the next position) (default: multipv)" << std::endl;
+    std::cout << "  --multipv-ladder <l>  Adaptive mode MultiPV tiers below --multipv (default: 4,16,64)" << std::endl;
+    std::cout << "  --triage-depth <n>    Search all moves at depth n first, then only candidates at --depth (default: off)" << std::endl;
+    std::cout << "  --triage-fraction <f> Re-search when the shallow loss exceeds f * threshold (default: 0.5)" << std::endl;
+    std::cout << "  --early-stop <k>      Stop a search once the played move was clearly fine or clearly a blunder" << std::endl;
+    std::cout << "                        for k iterations in a row (multipv and adaptive mode, default: off)" << std::endl;
+    std::cout << "  --nodes <n>           Also stop each search after n nodes (default: no limit)" << std::endl;
+    std::cout << "  --movetime <ms>       Also stop each search after ms milliseconds (default: no limit)" << std::endl;
+    std::cout << "  --time-budget <t>     Wall-clock budget for the whole run, e.g. 600, 90s, 30m or 2h; spread" << std::endl;
+    std::cout << "                        over the moves as movetimes, more for volatile positions (default: off)" << std::endl;
+    std::cout << "  --parse-threads <n>   Threads parsing large PGN files (default: auto-detect)" << std::endl;
+    std::cout << "  --position <p>        Position sent to the engine: 'fen' (FEN after the last capture or pawn" << std::endl;
+    std::cout << "                        move plus the moves since) or 'moves' (the whole game) (default: fen)" << std::endl;
+    std::cout << "  --dedup               Search positions that several games reach once per run (reads the" << std::endl;
+    std::cout << "                        whole file first)" << std::endl;
+    std::cout << "  --cache <file>        Keep engine results in a persistent cache file shared between runs" << std::endl;
+    std::cout << "  --cache-size <MB>     Size of a newly created cache file (default: 256)" << std::endl;
     std::cout << "  --games <selection>   Analyze specific games: '2' or '2-5' or '2,6,9' (default: all)" << std::endl;
     std::cout << "  --blunders-only       Only show blunders, skip per-move output" << std::endl;
     std::cout << "  --stockfish <path>    Path to Stockfish binary (default: stockfish)" << std::endl;
-    std::cout << "  --pgn-extract <path>  Path to pgn-extract binary (default: pgn-extract)" << std::endl;
     std::cout << "  --debug               Enable debug logging to stockfish_debug.log" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << programName << " game.pgn --threshold 200 --depth 20" << std::endl;
     std::cout << "  " << programName << " game.pgn --games \"2-5\" --blunders-only" << std::endl;
     std::cout << "  " << programName << " game.pgn --games \"1,3,7\"" << std::endl;
+    std::cout << "  " << programName << " games.pgn --threads 64 --engines 16" << std::endl;
+    std::cout << "  " << programName << " games.pgn --depth 24 --engines 4 --hash-budget 8192 --hash-clear game" << std::endl;
+    std::cout << "  " << programName << " game.pgn --games \"5\" --depth 25 --engines 8 --ply-parallel" << std::endl;
+    std::cout << "  " << programName << " games.pgn --depth 22 --triage-depth 10 --blunders-only" << std::endl;
+    std::cout << "  " << programName << " tournament.pgn --cache tournament.cache --threshold 100" << std::endl;
+    std::cout << "  " << programName << " games.pgn --depth 30 --time-budget 2h --engines 4" << std::endl;
 }
 
 std::set<int> Config::parseGameSelection() const {
@@ -174,3 +390,53 @@ std::set<int> Config::parseGameSelection() const {
 
     return selectedGames;
 }
+
+int Config::threadsPerEngine() const {
+    int perEngine = threads / engines;
+    return perEngine > 0 ? perEngine : 1;
+}
+
+int Config::hashPerEngine() const {
+    if (hashBudgetMB > 0) {
+        return hashBudgetMB / engines;
+    }
+    return hashMB;
+}
+
+int Config::hashClearInterval() const {
+    if (hashClear.empty() || hashClear.find_first_not_of("0123456789") != std::string::npos) {
+        return 0;
+    }
+    return atoi(hashClear.c_str());
+}
+
+int Config::engineMultiPV() const {
+    if (analysisMode == "searchmoves" || analysisMode == "chain") {
+        return 1;
+    }
+    if (analysisMode == "adaptive") {
+        return parseMultiPVLadder()[0];
+    }
+    return multiPV;
+}
+
+bool Config::limitsDepth() const {
+    return earlyStop > 0 || nodes > 0 || moveTime > 0 || timeBudget > 0.0;
+}
+
+std::vector<int> Config::parseMultiPVLadder() const {
+    std::set<int> tiers;
+
+    std::istringstream iss(multiPVLadder);
+    std::string token;
+    while (std::getline(iss, token, ',')) {
+        int tier = atoi(token.c_str());
+        if (tier > 0 && tier < multiPV) {
+            tiers.insert(tier);
+        }
+    }
+
+    std::vector<int> ladder(tiers.begin(), tiers.end());
+    ladder.push_back(multiPV);
+    return ladder;
+}
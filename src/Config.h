@@ -12,9 +12,27 @@ public:
     int thresholdCP;
     int threads;
     int multiPV;  // Number of principal variations (top moves) to analyze
+    int engines;  // Number of Stockfish processes; threads are split across them
+    bool plyParallel;  // Spread the plies of each game across engines instead of whole games
+    int hashMB;  // Stockfish hash table per engine in MB (0 = Stockfish default)
+    int hashBudgetMB;  // Hash for all engines together, split evenly (0 = use hashMB)
+    std::string hashClear;  // When to clear the hash: "never", "game" or every N plies ("N")
+    bool backward;  // Search the plies of each game from the last to the first
+    std::string analysisMode;  // "multipv", "searchmoves", "adaptive" or "chain"
+    std::string multiPVLadder;  // Adaptive mode: MultiPV tiers below multiPV, e.g. "4,16,64"
+    int triageDepth;  // Shallow first-pass depth; 0 disables triage
+    double triageFraction;  // Re-search at full depth when the shallow loss exceeds this share of thresholdCP
+    int earlyStop;  // Stop a search once the verdict on the played move held for this many iterations (0 = off)
+    long long nodes;  // Node limit per search besides the depth (0 = none)
+    int moveTime;  // Time limit per search in milliseconds besides the depth (0 = none)
+    double timeBudget;  // Wall-clock seconds for the whole run, spread over the plies as movetimes (0 = none)
     std::string stockfishPath;
-    std::string pgnExtractPath;
     std::string inputPgnFile;
+    int parseThreads;  // Threads parsing the PGN file ahead of the analysis
+    std::string positionMode;  // "fen" (FEN of the last irreversible move + moves since) or "moves" (whole game)
+    bool dedupPositions;  // Search positions shared by several games only once
+    std::string cacheFile;  // Persistent evaluation cache ("" = no cache)
+    int cacheSizeMB;  // Size of a newly created cache file
     std::string gameSelection;  // e.g., "2", "2-5", "2,6,9"
     bool debugMode;
     bool blundersOnly;  // Only show blunders, skip per-move output
@@ -28,6 +46,26 @@ public:
     // Parse game selection string (e.g., "2", "2-5", "2,6,9") into a set of game indices (1-based)
     // Returns empty set if no selection (meaning all games)
     std::set<int> parseGameSelection() const;
+
+    // Threads given to each engine process (threads split evenly, at least 1)
+    int threadsPerEngine() const;
+
+    // Hash size in MB each engine is started with (0 = leave Stockfish's default)
+    int hashPerEngine() const;
+
+    // Plies an engine searches between hash clears with --hash-clear N (0 otherwise)
+    int hashClearInterval() const;
+
+    // MultiPV the engines are started with (searchmoves and chain mode only need the
+    // best line, adaptive mode starts at the first tier)
+    int engineMultiPV() const;
+
+    // Whether searches can end below --depth (early stop, node or time limits)
+    bool limitsDepth() const;
+
+    // Adaptive mode MultiPV tiers: the ladder entries below multiPV in ascending
+    // order, followed by multiPV itself as the last tier
+    std::vector<int> parseMultiPVLadder() const;
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,297 @@
+#include "EvalCache.h"
+#include "Move.h"
+#include "StockfishEngine.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char CACHE_MAGIC[8] = { 'F', 'P', 'E', 'V', 'A', 'L', '\0', '\0' };
+static const uint32_t CACHE_VERSION = 1;
+
+struct EvalCache::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t slotCount;     // Power of two
+    uint64_t dataCapacity;  // Bytes
+    uint64_t dataUsed;
+    uint64_t entries;
+    uint64_t reserved[2];
+};
+
+// key 0 marks an empty slot (keys are never 0, see normalizeKey())
+struct EvalCache::Slot {
+    uint64_t key;
+    uint64_t params;
+    uint64_t offset;  // Into the data area
+    uint32_t size;    // Bytes
+    uint16_t count;   // Number of moves
+    uint8_t depth;
+    uint8_t flags;
+};
+
+// Packed move record in the data area, followed by pvLength packed PV moves
+struct CachedMove {
+    uint16_t move;
+    int16_t scoreCP;
+    int16_t mateInN;
+    uint8_t isMate;
+    uint8_t pvLength;
+};
+
+static const uint8_t FLAG_BEST_MOVE_CHANGED = 1;
+
+static uint64_t normalizeKey(uint64_t key) {
+    return key != 0 ? key : 1;
+}
+
+// Locks the file for the lifetime of the object
+class FileLock {
+public:
+    FileLock(int lockFd, int operation) : fd(lockFd) { flock(fd, operation); }
+    ~FileLock() { flock(fd, LOCK_UN); }
+private:
+    int fd;
+};
+
+EvalCache::EvalCache()
+    : fd(-1)
+    , base(NULL)
+    , mappedSize(0)
+    , header(NULL)
+    , slots(NULL)
+    , data(NULL)
+    , hits(0)
+    , misses(0)
+    , stores(0)
+    , full(false)
+{
+}
+
+EvalCache::~EvalCache() {
+    close();
+}
+
+bool EvalCache::open(const std::string& path, size_t sizeMB) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open cache file " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    FileLock lock(fd, LOCK_EX);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Error: Cannot stat cache file " << path << std::endl;
+        close();
+        return false;
+    }
+
+    size_t fileSize = st.st_size;
+    bool create = (fileSize == 0);
+    Header fresh;
+    if (create) {
+        // An eighth of the file for slots (power of two), the rest for data
+        uint64_t totalBytes = (uint64_t)sizeMB * 1024 * 1024;
+        uint64_t slotCount = 1024;
+        while (slotCount * 2 * sizeof(Slot) <= totalBytes / 8) {
+            slotCount *= 2;
+        }
+
+        memset(&fresh, 0, sizeof(fresh));
+        memcpy(fresh.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        fresh.version = CACHE_VERSION;
+        fresh.headerSize = sizeof(Header);
+        fresh.slotCount = slotCount;
+        fresh.dataCapacity = totalBytes - sizeof(Header) - slotCount * sizeof(Slot);
+        fileSize = sizeof(Header) + slotCount * sizeof(Slot) + fresh.dataCapacity;
+
+        if (ftruncate(fd, fileSize) != 0) {
+            std::cerr << "Error: Cannot size cache file " << path << ": " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+    } else if (fileSize < sizeof(Header)) {
+        std::cerr << "Error: " << path << " is not a findepatzer cache file" << std::endl;
+        close();
+        return false;
+    }
+
+    void* mapped = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Cannot map cache file " << path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<unsigned char*>(mapped);
+    mappedSize = fileSize;
+    header = reinterpret_cast<Header*>(base);
+
+    if (create) {
+        *header = fresh;
+    } else if (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+               header->version != CACHE_VERSION || header->headerSize != sizeof(Header) ||
+               (header->slotCount & (header->slotCount - 1)) != 0 ||
+               sizeof(Header) + header->slotCount * sizeof(Slot) + header->dataCapacity != fileSize) {
+        std::cerr << "Error: " << path << " is not a findepatzer cache file (or from another version)" << std::endl;
+        close();
+        return false;
+    }
+
+    slots = reinterpret_cast<Slot*>(base + sizeof(Header));
+    data = base + sizeof(Header) + header->slotCount * sizeof(Slot);
+    return true;
+}
+
+void EvalCache::close() {
+    if (base != NULL) {
+        munmap(base, mappedSize);
+        base = NULL;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    mappedSize = 0;
+    header = NULL;
+    slots = NULL;
+    data = NULL;
+}
+
+uint64_t EvalCache::getEntries() const {
+    return header != NULL ? header->entries : 0;
+}
+
+EvalCache::Slot* EvalCache::findSlot(uint64_t key, uint64_t params) const {
+    uint64_t mask = header->slotCount - 1;
+    for (uint64_t i = 0, index = key & mask; i <= mask; i++, index = (index + 1) & mask) {
+        Slot* slot = &slots[index];
+        if (slot->key == 0 || (slot->key == key && slot->params == params)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+bool EvalCache::lookup(uint64_t key, uint64_t params, std::vector<MoveScore>& moves, int& depth, bool& bestMoveChanged) {
+    if (!isOpen()) {
+        return false;
+    }
+    key = normalizeKey(key);
+
+    std::lock_guard<std::mutex> guard(mutex);
+    FileLock lock(fd, LOCK_SH);
+
+    const Slot* slot = findSlot(key, params);
+    if (slot == NULL || slot->key == 0 || slot->offset + slot->size > header->dataCapacity) {
+        misses++;
+        return false;
+    }
+
+    moves.clear();
+    moves.reserve(slot->count);
+    const unsigned char* p = data + slot->offset;
+    const unsigned char* end = p + slot->size;
+    for (int i = 0; i < slot->count && p + sizeof(CachedMove) <= end; i++) {
+        CachedMove cached;
+        memcpy(&cached, p, sizeof(cached));
+        p += sizeof(cached);
+
+        MoveScore score;
+        score.move = cached.move;
+        score.scoreCP = cached.scoreCP;
+        score.isMate = cached.isMate != 0;
+        score.mateInN = cached.mateInN;
+        score.multiPVIndex = i + 1;
+        for (int j = 0; j < cached.pvLength && p + sizeof(uint16_t) <= end; j++) {
+            uint16_t pvMove;
+            memcpy(&pvMove, p, sizeof(pvMove));
+            p += sizeof(pvMove);
+            if (j > 0) {
+                score.pv += ' ';
+            }
+            score.pv += Move::fromPacked(pvMove).toUci();
+        }
+        moves.push_back(score);
+    }
+
+    depth = slot->depth;
+    bestMoveChanged = (slot->flags & FLAG_BEST_MOVE_CHANGED) != 0;
+    hits++;
+    return true;
+}
+
+void EvalCache::store(uint64_t key, uint64_t params, const std::vector<MoveScore>& moves, int depth, bool bestMoveChanged) {
+    if (!isOpen() || full || moves.empty() || moves.size() > 0xFFFF) {
+        return;
+    }
+    key = normalizeKey(key);
+
+    // Pack outside the lock; results with moves that do not pack are not cached
+    std::vector<unsigned char> record;
+    for (size_t i = 0; i < moves.size(); i++) {
+        std::vector<uint16_t> pv;
+        size_t pos = 0;
+        while (pos < moves[i].pv.size() && pv.size() < 255) {
+            size_t next = moves[i].pv.find(' ', pos);
+            if (next == std::string::npos) {
+                next = moves[i].pv.size();
+            }
+            if (next > pos) {
+                pv.push_back(Move::fromUci(moves[i].pv.substr(pos, next - pos)).toPacked());
+            }
+            pos = next + 1;
+        }
+
+        CachedMove cached;
+        cached.move = moves[i].move;
+        if (cached.move == 0) {
+            return;
+        }
+        cached.scoreCP = static_cast<int16_t>(moves[i].scoreCP);
+        cached.mateInN = static_cast<int16_t>(moves[i].mateInN);
+        cached.isMate = moves[i].isMate ? 1 : 0;
+        cached.pvLength = static_cast<uint8_t>(pv.size());
+
+        size_t offset = record.size();
+        record.resize(offset + sizeof(cached) + pv.size() * sizeof(uint16_t));
+        memcpy(&record[offset], &cached, sizeof(cached));
+        if (!pv.empty()) {
+            memcpy(&record[offset + sizeof(cached)], &pv[0], pv.size() * sizeof(uint16_t));
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    FileLock lock(fd, LOCK_EX);
+
+    // Keep the table at most 90% full so that probe sequences stay short
+    if (header->entries * 10 >= header->slotCount * 9 || header->dataUsed + record.size() > header->dataCapacity) {
+        full = true;
+        return;
+    }
+
+    Slot* slot = findSlot(key, params);
+    if (slot == NULL || slot->key != 0) {
+        return;  // Stored by another engine or process in the meantime
+    }
+
+    memcpy(data + header->dataUsed, &record[0], record.size());
+    slot->params = params;
+    slot->offset = header->dataUsed;
+    slot->size = static_cast<uint32_t>(record.size());
+    slot->count = static_cast<uint16_t>(moves.size());
+    slot->depth = static_cast<uint8_t>(depth > 255 ? 255 : depth);
+    slot->flags = bestMoveChanged ? FLAG_BEST_MOVE_CHANGED : 0;
+    slot->key = key;
+    header->dataUsed += record.size();
+    header->entries++;
+    stores++;
+}
@@ -0,0 +1,73 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct MoveScore;
+
+// Persistent cache of search results. The cache file is memory-mapped and
+// holds an open-addressing table of fixed-size slots followed by a data area
+// with the packed MoveScore lists:
+//
+//   header | slot[slotCount] | data (append-only)
+//
+// A slot is found by the position key and must also match the search
+// parameters (depth, MultiPV, ...). Entries are never replaced; once the
+// table or the data area is full, new results are no longer stored.
+// Several processes can share one file: lookups take a shared flock(), inserts
+// an exclusive one (plus a mutex for the threads of this process).
+class EvalCache {
+public:
+    EvalCache();
+    ~EvalCache();
+
+    // Open or create the cache file; sizeMB is only used when the file is
+    // created. Returns false (with a message on stderr) on failure.
+    bool open(const std::string& path, size_t sizeMB);
+    void close();
+    bool isOpen() const { return base != NULL; }
+
+    // Look up the result of a search; fills moves, depth (last complete
+    // iteration) and bestMoveChanged on a hit
+    bool lookup(uint64_t key, uint64_t params, std::vector<MoveScore>& moves, int& depth, bool& bestMoveChanged);
+
+    // Store the result of a search (no-op if already present or full)
+    void store(uint64_t key, uint64_t params, const std::vector<MoveScore>& moves, int depth, bool bestMoveChanged);
+
+    long getHits() const { return hits; }
+    long getMisses() const { return misses; }
+    long getStores() const { return stores; }
+    uint64_t getEntries() const;
+    bool isFull() const { return full; }
+
+private:
+    struct Header;
+    struct Slot;
+
+    int fd;
+    unsigned char* base;   // Mapped file
+    size_t mappedSize;
+    Header* header;
+    Slot* slots;
+    unsigned char* data;
+    std::mutex mutex;      // flock() does not exclude threads of the same process
+
+    std::atomic<long> hits;
+    std::atomic<long> misses;
+    std::atomic<long> stores;
+    std::atomic<bool> full;
+
+    // Slot holding key/params, or the empty slot where it would go (NULL if the table is full)
+    Slot* findSlot(uint64_t key, uint64_t params) const;
+
+    // Non-copyable
+    EvalCache(const EvalCache&);
+    EvalCache& operator=(const EvalCache&);
+};
+
+#endif // EVAL_CACHE_H
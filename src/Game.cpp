@@ -1,22 +1,143 @@
 #include "Game.h"
+#include "Board.h"
+#include "StringPool.h"
 
-Game::Game() {
+Game::Game()
+    : startPly(0)
+{
 }
 
-void Game::addMove(const std::string& uci) {
-    moves.push_back(uci);
+void Game::addMove(PackedMove move) {
+    moves.push_back(move);
 }
 
-void Game::setHeader(const std::string& key, const std::string& value) {
-    headers[key] = value;
+// Pool text beyond which new tag values stay in the game (many distinct
+// players or events in a huge archive must not grow memory without bound)
+static const size_t POOLED_VALUE_LIMIT = 16 * 1024 * 1024;
+
+// Names of common tags, resolved without touching a pool (and its lock)
+static StringView standardTagName(const StringView& name) {
+    static const StringView names[] = {
+        "Event", "Site", "Date", "Round", "White", "Black", "Result", "FEN", "SetUp",
+        "ECO", "Opening", "Variation", "TimeControl", "Termination", "Annotator", "Mode",
+        "WhiteElo", "BlackElo", "WhiteTitle", "BlackTitle", "WhiteFideId", "BlackFideId",
+        "WhiteTeam", "BlackTeam", "WhiteRatingDiff", "BlackRatingDiff", "Variant",
+        "PlyCount", "EventDate", "EventType", "UTCDate", "UTCTime", "Time", "Board"
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (name == names[i]) {
+            return names[i];
+        }
+    }
+    return StringView(NULL, 0);
+}
+
+// Tag name as stored in a header: a standard name or a copy in pool
+static StringView tagName(const StringView& name, StringPool& pool) {
+    StringView standard = standardTagName(name);
+    return standard.data != NULL ? standard : pool.intern(name);
+}
+
+// Tags whose values recur across the games of a database (not Site or Date,
+// which are per game in online databases: game URLs and timestamps)
+static bool isPooledTag(const StringView& name) {
+    static const char* const tags[] = {
+        "Event", "Round", "White", "Black", "Result", "ECO",
+        "Opening", "Variation", "TimeControl", "Termination", "WhiteElo", "BlackElo",
+        "WhiteTitle", "BlackTitle", "Variant", "SetUp", "PlyCount"
+    };
+    for (size_t i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+        if (name == tags[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Game::setHeader(const StringView& key, const StringView& value, StringPool& pool) {
+    GameHeader* header = NULL;
+    for (size_t i = 0; i < headers.size(); i++) {
+        if (headers[i].name == key) {
+            header = &headers[i];
+            break;
+        }
+    }
+    if (!header) {
+        headers.push_back(GameHeader());
+        header = &headers.back();
+        header->name = tagName(key, pool);
+    }
+
+    // Long values are unlikely to repeat (annotations, URLs)
+    StringView pooled;
+    if (isPooledTag(key) && value.size <= 64 &&
+        pool.tryIntern(value, POOLED_VALUE_LIMIT, pooled)) {
+        header->pooledValue = pooled.data;
+        header->valueOffset = 0;
+    } else {
+        header->pooledValue = NULL;
+        header->valueOffset = static_cast<uint32_t>(headerText.size());
+        headerText.append(value.data, value.size);
+    }
+    header->valueSize = static_cast<uint32_t>(value.size);
+
+    if (key == "FEN") {
+        startPly = 0;
+        if (!value.empty()) {
+            Board board;
+            board.setFromFen(value.str());
+            if (board.getFullMoveNumber() > 1) {
+                startPly = (board.getFullMoveNumber() - 1) * 2;
+            }
+            if (!board.isWhiteToMove()) {
+                startPly++;
+            }
+        }
+    }
+}
+
+void Game::moveToPool(StringPool& pool) {
+    for (size_t i = 0; i < headers.size(); i++) {
+        GameHeader& header = headers[i];
+        header.name = tagName(header.name, pool);
+        if (header.pooledValue == NULL) {
+            continue;
+        }
+
+        StringView value(header.pooledValue, header.valueSize);
+        StringView pooled;
+        if (pool.tryIntern(value, POOLED_VALUE_LIMIT, pooled)) {
+            header.pooledValue = pooled.data;
+        } else {
+            header.pooledValue = NULL;
+            header.valueOffset = static_cast<uint32_t>(headerText.size());
+            headerText.append(value.data, value.size);
+        }
+    }
+}
+
+StringView Game::getHeader(const StringView& key) const {
+    for (size_t i = 0; i < headers.size(); i++) {
+        if (headers[i].name == key) {
+            const GameHeader& header = headers[i];
+            const char* data = header.pooledValue ? header.pooledValue : headerText.data() + header.valueOffset;
+            return StringView(data, header.valueSize);
+        }
+    }
+    return StringView("?");
 }
 
-std::string Game::getHeader(const std::string& key) const {
-    std::map<std::string, std::string>::const_iterator it = headers.find(key);
-    if (it != headers.end()) {
-        return it->second;
+bool Game::hasStartFen() const {
+    for (size_t i = 0; i < headers.size(); i++) {
+        if (headers[i].name == "FEN") {
+            return headers[i].valueSize > 0;
+        }
     }
-    return "?";
+    return false;
+}
+
+std::string Game::getStartPosition() const {
+    return hasStartFen() ? getHeader("FEN").str() : "startpos";
 }
 
 void Game::addAnalysis(const MoveAnalysis& moveAnalysis) {
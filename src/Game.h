@@ -1,44 +1,92 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "Move.h"
+#include "StringPool.h"
+#include "StringView.h"
+#include <stdint.h>
 #include <string>
-#include <map>
 #include <vector>
 
 struct MoveAnalysis {
     int moveNumber;
-    std::string playedMove;      // UCI notation
+    bool whiteMove;
+    PackedMove playedMove;
     int playedScore;             // Centipawns
-    std::string bestMove;        // UCI notation
+    PackedMove bestMove;
     int bestScore;               // Centipawns
     int scoreDifference;         // abs(playedScore - bestScore)
     bool isMateScore;
     int mateInN;
+    int decisionDepth;           // Depth of the iteration the verdict was taken from
+    std::string bestLine;        // Best PV in UCI notation (triage deep pass only)
+    std::string playedLine;      // PV after the played move (triage deep pass only)
 
     MoveAnalysis()
         : moveNumber(0)
+        , whiteMove(true)
+        , playedMove(0)
         , playedScore(0)
+        , bestMove(0)
         , bestScore(0)
         , scoreDifference(0)
         , isMateScore(false)
         , mateInN(0)
+        , decisionDepth(0)
     {}
 };
 
+// Tag pair of a game. Common tag names are static strings; other names and
+// recurring values (players, event, result) are views into StringPool::shared()
+// (or the pool of the parser chunk the game came from); other values (FEN, site, date, and any
+// new value once the pool is full) are stored in the game's headerText and
+// located by offset, so copies of a game stay valid.
+struct GameHeader {
+    StringView name;
+    const char* pooledValue;     // NULL if the value is in headerText
+    uint32_t valueOffset;
+    uint32_t valueSize;
+};
+
 class Game {
 public:
-    std::map<std::string, std::string> headers;
-    std::vector<std::string> moves;
+    std::vector<GameHeader> headers;  // In file order
+    std::string headerText;
+    std::vector<PackedMove> moves;
     std::vector<MoveAnalysis> analysis;
 
     Game();
 
-    void addMove(const std::string& uci);
-    void setHeader(const std::string& key, const std::string& value);
-    std::string getHeader(const std::string& key) const;
+    void addMove(PackedMove move);
+
+    // Set a tag. Names and recurring values are kept in pool; parser threads
+    // pass a pool of their own, so they do not contend for the shared one.
+    void setHeader(const StringView& key, const StringView& value, StringPool& pool = StringPool::shared());
+
+    // Re-point names and values kept in another pool to pool (before the other
+    // pool is freed); values pool has no room for move into headerText
+    void moveToPool(StringPool& pool);
+
+    // Value of a tag, or "?" if the game has none. Values that are not pooled
+    // point into the game and are valid until it is changed or destroyed.
+    StringView getHeader(const StringView& key) const;
+
+    // Whether the game starts from a FEN tag instead of the initial position
+    bool hasStartFen() const;
+
+    // Start position for the engine: the FEN tag or "startpos"
+    std::string getStartPosition() const;
+
+    // Move number and side of a ply (index into moves), counted from the
+    // move number and side to move of the FEN tag
+    int getMoveNumber(size_t ply) const { return (startPly + ply) / 2 + 1; }
+    bool isWhiteMove(size_t ply) const { return (startPly + ply) % 2 == 0; }
 
     void addAnalysis(const MoveAnalysis& moveAnalysis);
     std::vector<MoveAnalysis> getBlunders(int threshold) const;
+
+private:
+    size_t startPly;  // Plies played before the first move (FEN tag)
 };
 
 #endif // GAME_H
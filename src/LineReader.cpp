@@ -0,0 +1,107 @@
+#include "LineReader.h"
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <cstring>
+
+LineReader::LineReader(size_t capacity)
+    : fd(-1)
+    , buffer(capacity)
+    , head(0)
+    , scanPos(0)
+    , tail(0)
+    , bytesRead(0)
+    , linesRead(0)
+{
+}
+
+void LineReader::reset(int newFd) {
+    fd = newFd;
+    head = 0;
+    scanPos = 0;
+    tail = 0;
+}
+
+LineReader::Status LineReader::readLine(StringView& line, int timeoutMs) {
+    while (true) {
+        // Check if we have a complete line in the buffer
+        const char* newline = static_cast<const char*>(memchr(&buffer[0] + scanPos, '\n', tail - scanPos));
+        if (newline != NULL) {
+            size_t end = newline - &buffer[0];
+            line = StringView(&buffer[0] + head, end - head);
+            head = end + 1;
+            scanPos = head;
+            linesRead++;
+            return LINE;
+        }
+        scanPos = tail;
+
+        if (fd < 0) {
+            return CLOSED;
+        }
+
+        // Block until the pipe is readable
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ret = poll(&pfd, 1, timeoutMs);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret == 0) {
+            return TIMEOUT;
+        }
+        if (ret < 0) {
+            return FAILED;
+        }
+
+        if (!fill()) {
+            // End of stream: hand out whatever is left as the final line
+            fd = -1;
+            if (head < tail) {
+                line = StringView(&buffer[0] + head, tail - head);
+                head = tail;
+                scanPos = tail;
+                linesRead++;
+                return LINE;
+            }
+            return CLOSED;
+        }
+    }
+}
+
+bool LineReader::fill() {
+    if (head == tail) {
+        // Everything consumed: start over at the front for free
+        head = 0;
+        scanPos = 0;
+        tail = 0;
+    } else if (tail == buffer.size()) {
+        if (head > 0) {
+            // Move the incomplete line to the front
+            size_t pending = tail - head;
+            memmove(&buffer[0], &buffer[0] + head, pending);
+            scanPos -= head;
+            tail = pending;
+            head = 0;
+        } else {
+            // A single line fills the whole buffer
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+
+    ssize_t n;
+    do {
+        n = read(fd, &buffer[0] + tail, buffer.size() - tail);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        return false;
+    }
+
+    tail += n;
+    bytesRead += n;
+    return true;
+}
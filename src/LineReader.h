@@ -0,0 +1,48 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include "StringView.h"
+#include <vector>
+
+// Buffered line reader for a pipe. Data is read in large chunks into a
+// fixed-capacity buffer and lines are handed out as views into it, so no
+// line is copied. Only an incomplete trailing line is ever moved (to the
+// front of the buffer when the end is reached), which keeps the cost per
+// byte constant no matter how much output is queued. The buffer only grows
+// if a single line is longer than its capacity.
+class LineReader {
+public:
+    enum Status {
+        LINE,     // A line was returned
+        TIMEOUT,  // No complete line within the timeout
+        CLOSED,   // End of stream or read error, no more data
+        FAILED    // poll() failed
+    };
+
+    explicit LineReader(size_t capacity = 64 * 1024);
+
+    // Start reading from a new file descriptor (discards buffered data)
+    void reset(int fd);
+
+    // Read the next line (without '\n'). The view stays valid until the next
+    // call. At end of stream a final unterminated line is still returned.
+    Status readLine(StringView& line, int timeoutMs);
+
+    // Throughput counters
+    unsigned long long getBytesRead() const { return bytesRead; }
+    unsigned long long getLinesRead() const { return linesRead; }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t head;     // Start of unconsumed data
+    size_t scanPos;  // Everything in [head, scanPos) is known to contain no '\n'
+    size_t tail;     // End of valid data
+    unsigned long long bytesRead;
+    unsigned long long linesRead;
+
+    // Read more data into the buffer; returns false on end of stream or error
+    bool fill();
+};
+
+#endif // LINE_READER_H
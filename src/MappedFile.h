@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <string>
+
+// Read-only memory mapping of a whole file, advised for sequential access.
+// An empty file opens successfully with size 0.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Returns false (without a message) if the file cannot be opened or mapped,
+    // e.g. for pipes; callers then fall back to stream input
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return opened; }
+
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    size_t getSize() const { return size; }
+
+private:
+    const char* data;
+    size_t size;
+    bool opened;
+
+    // Non-copyable
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#endif // MAPPED_FILE_H
@@ -1,4 +1,5 @@
 #include "Move.h"
+#include <cctype>
 
 Move::Move()
     : fromSquare(-1)
@@ -44,6 +45,71 @@ std::string Move::toUci() const {
     return result;
 }
 
+PackedMove Move::toPacked() const {
+    if (!isValid()) {
+        return 0;
+    }
+
+    int promo = 0;
+    switch (tolower(promotion)) {
+        case 'n': promo = 1; break;
+        case 'b': promo = 2; break;
+        case 'r': promo = 3; break;
+        case 'q': promo = 4; break;
+    }
+    return static_cast<PackedMove>(fromSquare | (toSquare << 6) | (promo << 12));
+}
+
+static const char packedPromotions[] = { '\0', 'n', 'b', 'r', 'q', '\0', '\0', '\0' };
+
+Move Move::fromPacked(PackedMove packed) {
+    return Move(packed & 63, (packed >> 6) & 63, packedPromotions[(packed >> 12) & 7]);
+}
+
+PackedMove Move::uciToPacked(const StringView& uci) {
+    if (uci.size < 4 || uci.size > 5 ||
+        uci[0] < 'a' || uci[0] > 'h' || uci[1] < '1' || uci[1] > '8' ||
+        uci[2] < 'a' || uci[2] > 'h' || uci[3] < '1' || uci[3] > '8') {
+        return 0;
+    }
+
+    int from = (uci[1] - '1') * 8 + (uci[0] - 'a');
+    int to = (uci[3] - '1') * 8 + (uci[2] - 'a');
+    int promo = 0;
+    if (uci.size == 5) {
+        switch (tolower(uci[4])) {
+            case 'n': promo = 1; break;
+            case 'b': promo = 2; break;
+            case 'r': promo = 3; break;
+            case 'q': promo = 4; break;
+            default: return 0;
+        }
+    }
+    return static_cast<PackedMove>(from | (to << 6) | (promo << 12));
+}
+
+std::string Move::packedToUci(PackedMove packed) {
+    std::string result;
+    appendPackedUci(result, packed);
+    return result;
+}
+
+void Move::appendPackedUci(std::string& out, PackedMove packed) {
+    if (packed == 0) {
+        return;
+    }
+
+    int from = packed & 63;
+    int to = (packed >> 6) & 63;
+    out += char('a' + from % 8);
+    out += char('1' + from / 8);
+    out += char('a' + to % 8);
+    out += char('1' + to / 8);
+    if (packedPromotions[(packed >> 12) & 7] != '\0') {
+        out += packedPromotions[(packed >> 12) & 7];
+    }
+}
+
 bool Move::isValid() const {
     return fromSquare >= 0 && fromSquare < 64 &&
            toSquare >= 0 && toSquare < 64;
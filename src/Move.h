@@ -1,8 +1,14 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include "StringView.h"
+#include <stdint.h>
 #include <string>
 
+// Move packed into 16 bits (see Move::toPacked()), 0 = no move. Moves are
+// stored and compared in this form; UCI text is only produced for output.
+typedef uint16_t PackedMove;
+
 class Move {
 public:
     int fromSquare;  // 0-63 (a1=0, b1=1, ..., h8=63)
@@ -15,6 +21,19 @@ public:
     static Move fromUci(const std::string& uci);
     std::string toUci() const;
 
+    // 16-bit encoding: from (bits 0-5), to (bits 6-11), promotion (bits 12-14:
+    // 0 none, 1 n, 2 b, 3 r, 4 q); 0 is not a valid move (a1a1)
+    PackedMove toPacked() const;
+    static Move fromPacked(PackedMove packed);
+
+    // Pack UCI text ("e7e8q", promotion piece in either case) without building
+    // a Move; 0 if the text is not a move
+    static PackedMove uciToPacked(const StringView& uci);
+
+    // UCI text of a packed move ("" for 0); appendPackedUci() adds it to out
+    static std::string packedToUci(PackedMove packed);
+    static void appendPackedUci(std::string& out, PackedMove packed);
+
     bool isValid() const;
     bool isPromotion() const;
 
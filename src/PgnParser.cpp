@@ -1,111 +1,547 @@
 #include "PgnParser.h"
+#include "ByteScan.h"
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#include <cctype>
+#include <cstring>
+#include <utility>
 
-std::vector<Game> PgnParser::parseFile(const std::string& filename) {
-    std::vector<Game> games;
-    std::ifstream file(filename.c_str());
+// Chunks are large enough to amortize the hand-off, and only a few per
+// thread are parsed ahead of the consumer to keep memory bounded
+static const size_t CHUNK_SIZE = 4 * 1024 * 1024;
+static const size_t CHUNKS_PER_THREAD = 2;
+
+PgnParser::PgnParser()
+    : mapPos(NULL)
+    , mapEnd(NULL)
+    , in(NULL)
+    , haveLine(false)
+    , gameNumber(0)
+    , warnings(true)
+    , warningLog(NULL)
+    , headerPool(&StringPool::shared())
+    , threads(1)
+    , splitPos(NULL)
+    , nextInChunk(0)
+    , stopping(false)
+{
+}
+
+PgnParser::~PgnParser() {
+    stopWorkers();
+}
+
+void PgnParser::reset() {
+    stopWorkers();
+    haveLine = false;
+    state = MoveTextState();
+    gameNumber = 0;
+}
+
+bool PgnParser::open(const std::string& filename) {
+    reset();
+
+    if (mapped.open(filename)) {
+        in = NULL;
+        mapPos = mapped.begin();
+        mapEnd = mapped.end();
+        if (threads > 1 && mapped.getSize() > CHUNK_SIZE) {
+            startWorkers();
+        }
+        return true;
+    }
+
+    file.open(filename.c_str());
 
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open PGN file: " << filename << std::endl;
+        return false;
+    }
+
+    attach(file);
+    return true;
+}
+
+void PgnParser::attach(std::istream& stream) {
+    reset();
+    mapped.close();
+    mapPos = NULL;
+    mapEnd = NULL;
+    in = &stream;
+}
+
+void PgnParser::attachRange(const char* begin, const char* end) {
+    reset();
+    in = NULL;
+    mapPos = begin;
+    mapEnd = end;
+}
+
+std::vector<Game> PgnParser::parseFile(const std::string& filename) {
+    std::vector<Game> games;
+    PgnParser parser;
+    if (!parser.open(filename)) {
         return games;
     }
 
-    Game currentGame;
-    bool inHeaders = false;
+    Game game;
+    while (parser.nextGame(game)) {
+        games.push_back(std::move(game));
+    }
+    return games;
+}
+
+std::vector<Game> PgnParser::parseStream(std::istream& stream) {
+    std::vector<Game> games;
+    PgnParser parser;
+    parser.attach(stream);
+
+    Game game;
+    while (parser.nextGame(game)) {
+        games.push_back(std::move(game));
+    }
+    return games;
+}
+
+bool PgnParser::readLine() {
+    // A header line that ended the previous game is handed out first
+    if (haveLine) {
+        haveLine = false;
+        return true;
+    }
+
+    if (mapPos != NULL) {
+        if (mapPos >= mapEnd) {
+            return false;
+        }
+        const char* newline = ByteScan::find(mapPos, mapEnd, '\n');
+        line = StringView(mapPos, newline - mapPos);
+        mapPos = (newline < mapEnd) ? newline + 1 : newline;
+    } else {
+        if (in == NULL || !std::getline(*in, lineBuffer)) {
+            return false;
+        }
+        line = StringView(lineBuffer);
+    }
+
+    if (!line.empty() && line[line.size - 1] == '\r') {
+        line.size--;
+    }
+    return true;
+}
+
+bool PgnParser::nextGame(Game& game) {
+    if (!workers.empty()) {
+        return nextChunkGame(game);
+    }
+
+    game = Game();
     bool inMoves = false;
-    std::string line;
-
-    while (std::getline(file, line)) {
-        // Skip empty lines between games
-        if (line.empty()) {
-            if (inMoves && !currentGame.moves.empty()) {
-                // End of game
-                games.push_back(currentGame);
-                currentGame = Game();
-                inHeaders = false;
-                inMoves = false;
-            }
+
+    while (readLine()) {
+        // Skip empty lines and escaped lines
+        if (line.empty() || line[0] == '%') {
             continue;
         }
 
-        // Parse header lines
-        if (line[0] == '[') {
-            inHeaders = true;
-            inMoves = false;
+        // Parse header lines; a header after movetext starts the next game
+        if (line[0] == '[' && !(inMoves && state.inComment)) {
+            if (inMoves) {
+                if (!game.moves.empty()) {
+                    haveLine = true;  // Kept for the next call
+                    return true;
+                }
+                game = Game();
+                inMoves = false;
+            }
 
-            std::string key, value;
+            StringView key, value;
             if (parseHeaderLine(line, key, value)) {
-                currentGame.setHeader(key, value);
+                game.setHeader(key, value, *headerPool);
             }
+            continue;
         }
-        // Parse move lines (UCI notation)
-        else if (inHeaders || inMoves) {
+
+        // Parse move lines (SAN or UCI notation)
+        if (!inMoves) {
             inMoves = true;
-            std::vector<std::string> moves = parseMoveText(line);
-            for (size_t i = 0; i < moves.size(); i++) {
-                currentGame.addMove(moves[i]);
+            state = MoveTextState();
+            state.gameNumber = ++gameNumber;
+            if (game.hasStartFen()) {
+                state.board.setFromFen(game.getHeader("FEN").str());
             }
         }
+        parseMoveText(line, game);
     }
 
-    // Don't forget last game if file doesn't end with blank line
-    if (!currentGame.moves.empty()) {
-        games.push_back(currentGame);
+    // Last game of the input
+    return !game.moves.empty();
+}
+
+void PgnParser::startWorkers() {
+    stopping = false;
+    splitPos = mapPos;
+    nextInChunk = 0;
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::thread(&PgnParser::workerLoop, this));
     }
+}
 
-    file.close();
-    return games;
+void PgnParser::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        stopping = true;
+    }
+    chunkTaken.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+    chunks.clear();
+}
+
+void PgnParser::workerLoop() {
+    size_t window = threads * CHUNKS_PER_THREAD;
+    while (true) {
+        // Claim the next chunk once there is room in the window
+        Chunk* chunk;
+        {
+            std::unique_lock<std::mutex> lock(chunkMutex);
+            while (!stopping && splitPos < mapEnd && chunks.size() >= window) {
+                chunkTaken.wait(lock);
+            }
+            if (stopping || splitPos >= mapEnd) {
+                break;
+            }
+            chunks.emplace_back();
+            chunk = &chunks.back();  // deque::emplace_back keeps references valid
+            chunk->begin = splitPos;
+            chunk->end = findChunkEnd(splitPos);
+            splitPos = chunk->end;
+        }
+
+        PgnParser parser;
+        parser.attachRange(chunk->begin, chunk->end);
+        parser.warningLog = &chunk->warnings;
+        parser.headerPool = &chunk->pool;
+        Game game;
+        while (parser.nextGame(game)) {
+            chunk->games.push_back(std::move(game));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            chunk->gameCount = parser.gameNumber;
+            chunk->parsed = true;
+        }
+        chunkParsed.notify_all();
+    }
+
+    // Wake the consumer in case the last chunk has been claimed
+    chunkParsed.notify_all();
+}
+
+bool PgnParser::nextChunkGame(Game& game) {
+    std::unique_lock<std::mutex> lock(chunkMutex);
+    while (true) {
+        while (!(chunks.empty() ? splitPos >= mapEnd : chunks.front().parsed)) {
+            chunkParsed.wait(lock);
+        }
+        if (chunks.empty()) {
+            return false;
+        }
+
+        Chunk& chunk = chunks.front();
+        if (!chunk.reported) {
+            chunk.reported = true;
+            for (size_t i = 0; warnings && i < chunk.warnings.size(); i++) {
+                const Warning& warning = chunk.warnings[i];
+                printIllegalMove(gameNumber + warning.gameNumber, warning.token, warning.plies);
+            }
+        }
+
+        if (nextInChunk < chunk.games.size()) {
+            game = std::move(chunk.games[nextInChunk++]);
+
+            // The chunk (and its pool) stays until the next call, so the game
+            // moves to the shared pool outside the chunk lock
+            lock.unlock();
+            game.moveToPool(StringPool::shared());
+            return true;
+        }
+
+        // Chunk done: numbering continues after its games
+        gameNumber += chunk.gameCount;
+        chunks.pop_front();
+        nextInChunk = 0;
+        chunkTaken.notify_all();
+    }
+}
+
+const char* PgnParser::findChunkEnd(const char* begin) const {
+    if (static_cast<size_t>(mapEnd - begin) <= CHUNK_SIZE) {
+        return mapEnd;
+    }
+
+    for (const char* p = ByteScan::find(begin + CHUNK_SIZE, mapEnd, '['); p < mapEnd;
+         p = ByteScan::find(p + 1, mapEnd, '[')) {
+        if (p[-1] != '\n' || !StringView(p, mapEnd - p).startsWith("[Event ")) {
+            continue;
+        }
+
+        // Keep tag lines written before [Event with their game
+        const char* lineStart = p;
+        while (lineStart > begin + 1) {
+            const char* previous = lineStart - 1;  // '\n' ending the previous line
+            while (previous > begin && previous[-1] != '\n') {
+                previous--;
+            }
+            if (*previous != '[') {
+                break;
+            }
+            lineStart = previous;
+        }
+        return lineStart;
+    }
+    return mapEnd;
 }
 
-bool PgnParser::parseHeaderLine(const std::string& line, std::string& key, std::string& value) {
+void PgnParser::printIllegalMove(int gameNumber, const std::string& token, size_t plies) {
+    std::cerr << "Warning: Game " << gameNumber << ": illegal move '" << token
+              << "' after " << plies << " plies, ignoring the rest of the game" << std::endl;
+}
+
+bool PgnParser::parseHeaderLine(const StringView& text, StringView& key, StringView& value) {
     // Format: [Key "Value"]
-    size_t firstQuote = line.find('"');
-    size_t lastQuote = line.rfind('"');
+    const char* end = text.data + text.size;
+    const char* firstQuote = ByteScan::find(text.data, end, '"');
+    const char* lastQuote = end;
+    while (lastQuote > firstQuote && lastQuote[-1] != '"') {
+        lastQuote--;
+    }
 
-    if (firstQuote == std::string::npos || lastQuote == std::string::npos) {
+    if (firstQuote == end || lastQuote - 1 == firstQuote) {
         return false;
     }
+    lastQuote--;
 
     // Extract key (between '[' and first space/quote)
-    size_t keyStart = 1; // Skip '['
-    size_t keyEnd = line.find(' ', keyStart);
-    if (keyEnd == std::string::npos || keyEnd > firstQuote) {
-        keyEnd = firstQuote;
-    }
+    const char* keyStart = text.data + 1; // Skip '['
+    const char* keyEnd = ByteScan::find(keyStart, firstQuote, ' ');
 
-    key = line.substr(keyStart, keyEnd - keyStart);
+    key = StringView(keyStart, keyEnd - keyStart);
 
     // Extract value (between quotes)
-    value = line.substr(firstQuote + 1, lastQuote - firstQuote - 1);
+    value = StringView(firstQuote + 1, lastQuote - firstQuote - 1);
 
     return true;
 }
 
-std::vector<std::string> PgnParser::parseMoveText(const std::string& line) {
-    std::vector<std::string> moves;
-    std::istringstream iss(line);
-    std::string token;
+void PgnParser::parseMoveText(const StringView& text, Game& game) {
+    const char* p = text.data;
+    const char* end = text.data + text.size;
+    while (p < end) {
+        // Comments and variations may span lines; comment text is skipped
+        // with a block scan for the closing brace
+        if (state.inComment) {
+            p = ByteScan::find(p, end, '}');
+            if (p == end) {
+                return;
+            }
+            state.inComment = false;
+            p++;
+            continue;
+        }
 
-    while (iss >> token) {
-        // Skip result markers
-        if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+        char c = *p;
+        if (c == '{') {
+            state.inComment = true;
+            p++;
+            continue;
+        }
+        if (c == ';') {
+            return;  // Comment to end of line
+        }
+        if (c == '(') {
+            state.variationDepth++;
+            p++;
+            continue;
+        }
+        if (c == ')') {
+            if (state.variationDepth > 0) {
+                state.variationDepth--;
+            }
+            p++;
             continue;
         }
+        if (isspace(static_cast<unsigned char>(c))) {
+            p++;
+            continue;
+        }
+
+        const char* start = p;
+        while (p < end && !isspace(static_cast<unsigned char>(*p)) && strchr("{}();", *p) == NULL) {
+            p++;
+        }
+        if (state.variationDepth == 0 && !state.stopped) {
+            addMoveToken(StringView(start, p - start), game);
+        }
+    }
+}
+
+void PgnParser::addMoveToken(const StringView& rawToken, Game& game) {
+    // Skip result markers
+    if (rawToken == "1-0" || rawToken == "0-1" || rawToken == "1/2-1/2" || rawToken == "*") {
+        return;
+    }
 
-        // Skip anything that's not a valid UCI move
-        // UCI moves are 4-5 characters: e2e4, e7e8q
-        if (token.length() >= 4 && token.length() <= 5) {
-            // Basic validation: first two chars should be square, next two should be square
-            if (token[0] >= 'a' && token[0] <= 'h' &&
-                token[1] >= '1' && token[1] <= '8' &&
-                token[2] >= 'a' && token[2] <= 'h' &&
-                token[3] >= '1' && token[3] <= '8') {
-                moves.push_back(token);
+    // Skip NAGs ($1) and strip move numbers ("12." or "12...e5")
+    if (rawToken[0] == '$') {
+        return;
+    }
+    size_t start = 0;
+    while (start < rawToken.size && isdigit(static_cast<unsigned char>(rawToken[start]))) {
+        start++;
+    }
+    if (start < rawToken.size && rawToken[start] == '.') {
+        while (start < rawToken.size && rawToken[start] == '.') {
+            start++;
+        }
+    } else {
+        start = 0;
+    }
+
+    // Strip check marks and annotations (+, #, !, ?)
+    size_t end = rawToken.size;
+    while (end > start && strchr("+#!?", rawToken[end - 1]) != NULL) {
+        end--;
+    }
+    if (end == start) {
+        return;
+    }
+    StringView token = rawToken.substr(start, end - start);
+
+    Move move = parseMove(state.board, token);
+    if (!move.isValid()) {
+        if (warningLog != NULL) {
+            Warning warning;
+            warning.gameNumber = state.gameNumber;
+            warning.token = token.str();
+            warning.plies = game.moves.size();
+            warningLog->push_back(warning);
+        } else if (warnings) {
+            printIllegalMove(state.gameNumber, token.str(), game.moves.size());
+        }
+        state.stopped = true;
+        return;
+    }
+
+    state.board.makeMove(move);
+    game.addMove(move.toPacked());
+}
+
+Move PgnParser::parseMove(const Board& board, const StringView& token) {
+    // Candidates are matched against the pseudo-legal moves; only matches are
+    // checked for legality
+    std::vector<Move> candidates;
+    candidates.reserve(64);
+    board.generatePseudoLegalMoves(candidates);
+
+    // UCI move ("e2e4", "e7e8q")
+    if ((token.size == 4 || token.size == 5) &&
+        token[0] >= 'a' && token[0] <= 'h' && token[1] >= '1' && token[1] <= '8' &&
+        token[2] >= 'a' && token[2] <= 'h' && token[3] >= '1' && token[3] <= '8') {
+        int from = (token[1] - '1') * 8 + (token[0] - 'a');
+        int to = (token[3] - '1') * 8 + (token[2] - 'a');
+        char promotion = (token.size == 5) ? static_cast<char>(tolower(token[4])) : '\0';
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (candidates[i].fromSquare == from && candidates[i].toSquare == to &&
+                candidates[i].promotion == promotion && board.isLegal(candidates[i])) {
+                return candidates[i];
             }
         }
+        return Move();
+    }
+
+    // Castling
+    bool white = board.isWhiteToMove();
+    if (token == "O-O" || token == "0-0" || token == "O-O-O" || token == "0-0-0") {
+        int kingSquare = white ? 4 : 60;
+        int target = (token.size == 3) ? kingSquare + 2 : kingSquare - 2;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (candidates[i].fromSquare == kingSquare && candidates[i].toSquare == target &&
+                (board.getPieceAt(kingSquare) == WHITE_KING || board.getPieceAt(kingSquare) == BLACK_KING) &&
+                board.isLegal(candidates[i])) {
+                return candidates[i];
+            }
+        }
+        return Move();
+    }
+
+    // Piece letter (pawn moves have none)
+    StringView san = token;
+    Piece piece = white ? WHITE_PAWN : BLACK_PAWN;
+    if (!san.empty() && strchr("KQRBN", san[0]) != NULL) {
+        Piece whitePiece = Board::charToPiece(san[0]);
+        piece = white ? whitePiece : static_cast<Piece>(whitePiece + 6);
+        san = san.substr(1);
+    }
+
+    // Promotion ("e8=Q" or "e8Q")
+    char promotion = '\0';
+    if (san.size >= 2 && strchr("QRBN", san[san.size - 1]) != NULL) {
+        promotion = static_cast<char>(tolower(san[san.size - 1]));
+        san.size--;
+        if (!san.empty() && san[san.size - 1] == '=') {
+            san.size--;
+        }
+    }
+
+    // Destination square, then disambiguation (file and/or rank) before it
+    if (san.size < 2) {
+        return Move();
+    }
+    char toFile = san[san.size - 2];
+    char toRank = san[san.size - 1];
+    if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8') {
+        return Move();
+    }
+    int to = (toRank - '1') * 8 + (toFile - 'a');
+
+    int fromFile = -1;
+    int fromRank = -1;
+    for (size_t i = 0; i + 2 < san.size; i++) {
+        if (san[i] >= 'a' && san[i] <= 'h') {
+            fromFile = san[i] - 'a';
+        } else if (san[i] >= '1' && san[i] <= '8') {
+            fromRank = san[i] - '1';
+        } else if (san[i] != 'x' && san[i] != '-') {
+            return Move();
+        }
+    }
+    // Pawn promotions without a piece are taken as queen promotions
+    bool pawn = (piece == WHITE_PAWN || piece == BLACK_PAWN);
+    if (pawn && promotion == '\0' && (to >= 56 || to < 8)) {
+        promotion = 'q';
+    }
+
+    Move match;
+    int matches = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const Move& m = candidates[i];
+        if (m.toSquare != to || board.getPieceAt(m.fromSquare) != piece || m.promotion != promotion) {
+            continue;
+        }
+        if ((fromFile != -1 && m.fromSquare % 8 != fromFile) || (fromRank != -1 && m.fromSquare / 8 != fromRank)) {
+            continue;
+        }
+        if (!board.isLegal(m)) {
+            continue;
+        }
+        match = m;
+        matches++;
     }
 
-    return moves;
+    // Ambiguous SAN is rejected like an illegal move
+    return matches == 1 ? match : Move();
 }
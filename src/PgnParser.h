@@ -1,18 +1,132 @@
 #ifndef PGN_PARSER_H
 #define PGN_PARSER_H
 
+#include "Board.h"
 #include "Game.h"
+#include "MappedFile.h"
+#include "StringPool.h"
+#include "StringView.h"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <istream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+// Reads PGN with SAN (or UCI) movetext; moves are stored as packed moves.
+// Comments, NAGs and variations are skipped; a FEN tag sets the start position.
 class PgnParser {
 public:
-    // Parse UCI-formatted PGN file (output from pgn-extract -Wuci)
+    PgnParser();
+    ~PgnParser();
+
+    // Stream games from a file or an already open stream, one at a time, so
+    // memory does not grow with the size of the input. Regular files are
+    // memory-mapped and split into lines in place; other files (pipes) and
+    // attached streams are read line by line.
+    bool open(const std::string& filename);
+    void attach(std::istream& in);
+
+    // Read the next game (games without moves are skipped); false at end of input
+    bool nextGame(Game& game);
+
+    // Print a warning for illegal moves (default on)
+    void setWarnings(bool enabled) { warnings = enabled; }
+
+    // Parse mapped files on this many threads (set before open(); default 1).
+    // The file is split into chunks that start at an [Event tag; chunks are
+    // parsed ahead in parallel and their games handed out in file order, so
+    // game numbers are the same as with a single thread.
+    void setThreads(int count) { threads = count; }
+
+    // Read all games at once
     static std::vector<Game> parseFile(const std::string& filename);
+    static std::vector<Game> parseStream(std::istream& in);
+
+    // Resolve a SAN move ("Nbd7", "exd8=Q+", "O-O") or a UCI move ("e2e4")
+    // against the legal moves of the position; returns an invalid Move if the
+    // token is not a legal move there
+    static Move parseMove(const Board& board, const StringView& token);
 
 private:
-    static bool parseHeaderLine(const std::string& line, std::string& key, std::string& value);
-    static std::vector<std::string> parseMoveText(const std::string& line);
+    // Movetext state carried across lines of one game
+    struct MoveTextState {
+        Board board;
+        bool inComment;       // Inside {...}
+        int variationDepth;   // Nesting of (...)
+        bool stopped;         // Illegal move seen; the rest of the game is ignored
+        int gameNumber;       // 1-based, for messages
+
+        MoveTextState() : inComment(false), variationDepth(0), stopped(false), gameNumber(0) {}
+    };
+
+    // Illegal move found while parsing a chunk, reported when the chunk is handed out
+    struct Warning {
+        int gameNumber;       // Within the chunk
+        std::string token;
+        size_t plies;
+    };
+
+    // Part of the mapping parsed by a worker thread
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<Game> games;
+        std::vector<Warning> warnings;
+        StringPool pool;      // Tags of the games until they are handed out
+        int gameCount;        // Movetext sections (game numbers) in the chunk
+        bool parsed;
+        bool reported;        // Warnings printed
+
+        Chunk() : begin(NULL), end(NULL), gameCount(0), parsed(false), reported(false) {}
+    };
+
+    MappedFile mapped;
+    const char* mapPos;      // Next unread byte of the mapping (or chunk)
+    const char* mapEnd;
+    std::ifstream file;
+    std::istream* in;        // Stream input (when the file is not mapped)
+    std::string lineBuffer;  // Current line of stream input
+    StringView line;         // Current line, into the mapping or lineBuffer
+    bool haveLine;           // line is a header that ended the previous game
+    MoveTextState state;
+    int gameNumber;          // Movetext sections read so far (1-based game numbers in messages)
+    bool warnings;
+    std::vector<Warning>* warningLog;  // Chunk parsers collect warnings here
+    StringPool* headerPool;            // Tag names and values (the chunk's own pool in chunk parsers)
+
+    // Parallel parsing state (guarded by chunkMutex)
+    int threads;
+    std::vector<std::thread> workers;
+    std::mutex chunkMutex;
+    std::condition_variable chunkParsed;   // The consumer waits for the front chunk
+    std::condition_variable chunkTaken;    // Workers wait for room in the window
+    std::deque<Chunk> chunks;              // In file order; the front one is being handed out
+    const char* splitPos;                  // Start of the first chunk not yet assigned
+    size_t nextInChunk;                    // Next game of the front chunk
+    bool stopping;
+
+    bool readLine();
+    void reset();
+
+    // Parse a chunk of the mapping (worker threads)
+    void attachRange(const char* begin, const char* end);
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    bool nextChunkGame(Game& game);
+
+    // End of the chunk starting at begin: the first [Event tag line (with any
+    // tag lines right before it) at least chunkSize bytes in
+    const char* findChunkEnd(const char* begin) const;
+
+    static void printIllegalMove(int gameNumber, const std::string& token, size_t plies);
+
+    static bool parseHeaderLine(const StringView& text, StringView& key, StringView& value);
+    void parseMoveText(const StringView& text, Game& game);
+    void addMoveToken(const StringView& token, Game& game);
 };
 
 #endif // PGN_PARSER_H
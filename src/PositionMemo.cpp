@@ -0,0 +1,91 @@
+#include "PositionMemo.h"
+
+PositionMemo::PositionMemo()
+    : sharedPositions(0)
+    , sharedPlies(0)
+    , hits(0)
+{
+}
+
+void PositionMemo::addPosition(uint64_t key) {
+    int count = ++reachCount[key];
+    if (count == 2) {
+        shared.insert(key);
+        sharedPositions++;
+        sharedPlies += 2;
+    } else if (count > 2) {
+        sharedPlies++;
+    }
+}
+
+bool PositionMemo::isShared(uint64_t key) const {
+    return shared.find(key) != shared.end();
+}
+
+void PositionMemo::release(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::map<uint64_t, int>::iterator count = reachCount.find(key);
+    if (count == reachCount.end() || --count->second > 0) {
+        return;
+    }
+    reachCount.erase(count);
+
+    // Last ply: free the results of every search of the position. Engines still
+    // waiting on one (a search outside the reaching plies) search it themselves.
+    EntryMap::iterator first = entries.lower_bound(std::make_pair(key, (uint64_t)0));
+    EntryMap::iterator last = first;
+    while (last != entries.end() && last->first.first == key) {
+        ++last;
+    }
+    if (first != last) {
+        entries.erase(first, last);
+        published.notify_all();
+    }
+}
+
+bool PositionMemo::acquire(uint64_t key, uint64_t params, std::vector<MoveScore>& moves, int& depth, bool& bestMoveChanged) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (reachCount.find(key) == reachCount.end()) {
+        return false;  // Released: no ply needs the result any more
+    }
+    std::pair<uint64_t, uint64_t> id(key, params);
+    EntryMap::iterator it = entries.find(id);
+    if (it == entries.end()) {
+        entries.insert(std::make_pair(id, Entry()));
+        return false;  // First request: the caller searches
+    }
+
+    // An engine only waits while it has no search of its own outstanding, and
+    // the owner of an entry always publishes it, so this cannot deadlock
+    while (!it->second.ready) {
+        published.wait(lock);
+        it = entries.find(id);
+        if (it == entries.end()) {
+            return false;  // Released meanwhile
+        }
+    }
+
+    moves = it->second.moves;
+    depth = it->second.depth;
+    bestMoveChanged = it->second.bestMoveChanged;
+    hits++;
+    return true;
+}
+
+void PositionMemo::publish(uint64_t key, uint64_t params, const std::vector<MoveScore>& moves, int depth, bool bestMoveChanged) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Nothing to do if the position was released in the meantime
+    EntryMap::iterator it = entries.find(std::make_pair(key, params));
+    if (it == entries.end()) {
+        return;
+    }
+    Entry& entry = it->second;
+    entry.moves = moves;
+    entry.depth = depth;
+    entry.bestMoveChanged = bestMoveChanged;
+    entry.ready = true;
+    published.notify_all();
+}
@@ -0,0 +1,72 @@
+#ifndef POSITION_MEMO_H
+#define POSITION_MEMO_H
+
+#include "StockfishEngine.h"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+// In-memory results for positions that several selected games reach (shared
+// openings, transpositions). The positions are registered by a pre-pass over
+// the games; each is then searched by exactly one engine, and every other
+// engine asking for it waits for that result instead of searching again.
+// The results of a position are freed once every ply reaching it is analyzed.
+class PositionMemo {
+public:
+    PositionMemo();
+
+    // Pre-pass: register a position key reached by one ply
+    void addPosition(uint64_t key);
+
+    // A ply registered with addPosition() is analyzed; after the last one the
+    // results of the position are freed
+    void release(uint64_t key);
+
+    // Positions reached more than once, and how many plies reach them
+    size_t getSharedPositions() const { return sharedPositions; }
+    size_t getSharedPlies() const { return sharedPlies; }
+
+    // Whether key was reached more than once (only those are memoized)
+    bool isShared(uint64_t key) const;
+
+    // Get the result of a search. Returns true with the result if it is known;
+    // waits if another engine is searching it. Returns false if the caller is
+    // now responsible for the search and must call publish() when done (also
+    // for positions that are already released; nothing is kept for those).
+    bool acquire(uint64_t key, uint64_t params, std::vector<MoveScore>& moves, int& depth, bool& bestMoveChanged);
+
+    // Hand the result of an acquired search to the waiting engines
+    void publish(uint64_t key, uint64_t params, const std::vector<MoveScore>& moves, int depth, bool bestMoveChanged);
+
+    // Searches answered from the memo
+    long getHits() const { return hits; }
+
+private:
+    struct Entry {
+        bool ready;
+        std::vector<MoveScore> moves;
+        int depth;
+        bool bestMoveChanged;
+
+        Entry() : ready(false), depth(0), bestMoveChanged(false) {}
+    };
+
+    typedef std::map<std::pair<uint64_t, uint64_t>, Entry> EntryMap;
+
+    std::map<uint64_t, int> reachCount;  // Plies per position key not yet released
+    std::set<uint64_t> shared;
+    size_t sharedPositions;
+    size_t sharedPlies;
+
+    std::mutex mutex;
+    std::condition_variable published;
+    EntryMap entries;  // By position key and search parameters
+    std::atomic<long> hits;
+};
+
+#endif // POSITION_MEMO_H
@@ -0,0 +1,77 @@
+#include "SearchScheduler.h"
+#include <algorithm>
+
+// Shortest movetime handed out (ms); below this the pipe round-trip dominates
+static const int MIN_MOVETIME = 10;
+
+SearchScheduler::SearchScheduler()
+    : active(false)
+    , budget(0.0)
+    , engines(1)
+    , remainingPlies(0)
+    , pliesDone(0)
+    , allotted(0.0)
+    , weightSum(0.0)
+    , allocations(0)
+{
+}
+
+void SearchScheduler::start(double seconds, int numEngines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    active = true;
+    startTime = std::chrono::steady_clock::now();
+    budget = seconds;
+    engines = numEngines;
+}
+
+void SearchScheduler::setPlies(size_t plies) {
+    std::lock_guard<std::mutex> lock(mutex);
+    remainingPlies = plies;
+}
+
+int SearchScheduler::allocate(double weight) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double remaining = budget - std::chrono::duration<double>(now - startTime).count();
+    if (remaining <= 0.0) {
+        return MIN_MOVETIME;
+    }
+
+    // Equal share of the engine time left for each remaining ply
+    double share = remaining * engines / std::max<size_t>(remainingPlies, 1);
+
+    // Plies cost more than their movetime when a ply needs several searches;
+    // measured over the run once a few plies are done
+    if (allocations == 0) {
+        firstAllocation = now;
+    } else if (pliesDone >= 8 && allotted > 0.0) {
+        double cost = std::chrono::duration<double>(now - firstAllocation).count() * engines / allotted;
+        share /= std::min(std::max(cost, 0.5), 4.0);
+    }
+
+    // Volatile positions get more than the share, calm ones less
+    weightSum += weight;
+    allocations++;
+    share *= weight / (weightSum / allocations);
+
+    int ms = std::max(MIN_MOVETIME, static_cast<int>(share * 1000.0));
+    allotted += ms / 1000.0;
+    return ms;
+}
+
+void SearchScheduler::plyDone(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    remainingPlies -= std::min(count, remainingPlies);
+    pliesDone += count;
+}
+
+double SearchScheduler::getElapsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+double SearchScheduler::getRemaining() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget - std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,50 @@
+#ifndef SEARCH_SCHEDULER_H
+#define SEARCH_SCHEDULER_H
+
+#include <stddef.h>
+#include <chrono>
+#include <mutex>
+
+// Spreads a wall-clock budget for the whole run over the plies still to be
+// analyzed. Each search gets a movetime of its share of the remaining time on
+// all engines, scaled by a weight for how volatile the position looked (1 =
+// average) and by how much longer plies have actually taken than the time
+// handed out for them (follow-up searches, protocol overhead). Shares are
+// recomputed from the clock for every search, so plies that finish early
+// leave more time for the rest. Thread-safe.
+class SearchScheduler {
+public:
+    SearchScheduler();
+
+    // Start the clock for a run of the given length (seconds) on engines in parallel
+    void start(double seconds, int engines);
+    bool isActive() const { return active; }
+
+    // Plies the run has to analyze (known after the pre-pass)
+    void setPlies(size_t plies);
+
+    // Movetime in milliseconds for the next search
+    int allocate(double weight);
+
+    // Plies have been analyzed (or will not be searched at full depth)
+    void plyDone(size_t count = 1);
+
+    // Seconds since start() and seconds left before the deadline (negative once overrun)
+    double getElapsed() const;
+    double getRemaining() const;
+
+private:
+    mutable std::mutex mutex;
+    bool active;
+    std::chrono::steady_clock::time_point startTime;
+    double budget;          // Seconds for the run
+    int engines;
+    size_t remainingPlies;
+    size_t pliesDone;
+    std::chrono::steady_clock::time_point firstAllocation;
+    double allotted;        // Seconds handed out so far
+    double weightSum;       // Weights of all allocations (their mean normalizes the next one)
+    long allocations;
+};
+
+#endif // SEARCH_SCHEDULER_H
@@ -1,29 +1,157 @@
 #include "StockfishEngine.h"
+#include "UciInfo.h"
+#include "Board.h"
+#include "EvalCache.h"
+#include "PositionMemo.h"
 #include <iostream>
 #include <sstream>
 #include <unistd.h>
 #include <sys/wait.h>
-#include <sys/select.h>
 #include <fcntl.h>
 #include <cstring>
 #include <cstdlib>
+#include <cctype>
 #include <errno.h>
 
-StockfishEngine::StockfishEngine(const std::string& path, int depth, int numThreads, int numMultiPV, bool enableDebug)
+MultiPVAggregator::MultiPVAggregator()
+    : blockCount(0)
+    , blockDepth(0)
+    , blockHasBound(false)
+    , completeCount(0)
+    , completeDepth(0)
+    , bestMoveChanged(false)
+    , scoreSwing(0)
+    , capturePV(false)
+{
+}
+
+void MultiPVAggregator::reset() {
+    blockCount = 0;
+    blockDepth = 0;
+    blockHasBound = false;
+    completeCount = 0;
+    completeDepth = 0;
+    bestMoveChanged = false;
+    scoreSwing = 0;
+}
+
+void MultiPVAggregator::add(const UciInfo& info) {
+    // multipv 1 starts a new block of lines
+    if (info.multiPV <= blockCount || (info.multiPV == 1 && blockCount > 0)) {
+        closeBlock();
+    }
+
+    if ((int)block.size() < info.multiPV) {
+        block.resize(info.multiPV);
+    }
+
+    MoveScore& slot = block[info.multiPV - 1];
+    slot.move = Move::uciToPacked(info.pvMove);
+    slot.multiPVIndex = info.multiPV;
+    slot.scoreCP = info.scoreCP;
+    slot.isMate = info.isMate;
+    slot.mateInN = info.mateInN;
+    if (capturePV) {
+        slot.pv.assign(info.pv.data, info.pv.size);
+    } else {
+        slot.pv.clear();
+    }
+
+    // Track whether the block is one complete iteration so far
+    if (blockCount == 0) {
+        blockDepth = info.depth;
+    } else if (info.depth != blockDepth) {
+        blockDepth = -1;
+    }
+    if (info.isBound || info.pvMove.empty() || info.multiPV != blockCount + 1) {
+        blockHasBound = true;  // Not usable as a complete iteration
+    }
+    blockCount = info.multiPV;
+}
+
+void MultiPVAggregator::closeBlock() {
+    // Accept the block if all PVs carry the same depth and it is at least as
+    // deep and as wide as the last complete iteration
+    if (blockCount > 0 && blockDepth > 0 && !blockHasBound &&
+        blockDepth >= completeDepth && blockCount >= completeCount) {
+        if (blockDepth > completeDepth) {
+            bestMoveChanged = completeCount > 0 && block[0].move != complete[0].move;
+            if (completeCount > 0 && !block[0].isMate && !complete[0].isMate) {
+                scoreSwing = std::max(scoreSwing, abs(block[0].scoreCP - complete[0].scoreCP));
+            }
+        }
+        block.swap(complete);
+        completeCount = blockCount;
+        completeDepth = blockDepth;
+    }
+
+    blockCount = 0;
+    blockDepth = 0;
+    blockHasBound = false;
+}
+
+int MultiPVAggregator::getCompleteLoss(PackedMove move, int requestedLines) const {
+    if (completeCount == 0) {
+        return -1;
+    }
+    for (int i = 0; i < completeCount; i++) {
+        if (complete[i].move == move) {
+            return complete[0].scoreCP - complete[i].scoreCP;
+        }
+    }
+    return completeCount < requestedLines ? 9999 : -1;
+}
+
+void MultiPVAggregator::finish(std::vector<MoveScore>& results) {
+    closeBlock();
+    results.assign(complete.begin(), complete.begin() + completeCount);
+}
+
+// Debug log file name for an engine: engine 0 keeps the historical name,
+// pooled engines get a numbered suffix so they don't overwrite each other
+static std::string logFileName(const std::string& base, int engineId) {
+    if (engineId == 0) {
+        return base + ".log";
+    }
+    std::ostringstream name;
+    name << base << "_" << engineId << ".log";
+    return name.str();
+}
+
+StockfishEngine::StockfishEngine(const std::string& path, int depth, int numThreads, int numMultiPV, bool enableDebug, int engineId)
     : stockfishPath(path)
     , defaultDepth(depth)
     , threads(numThreads)
+    , hashMB(0)
+    , hashClearInterval(0)
+    , pliesSinceClear(0)
     , multiPV(numMultiPV)
     , debugMode(enableDebug)
+    , id(engineId)
     , pid(-1)
     , fdToEngine(-1)
     , fdFromEngine(-1)
-    , readBuffer("")
     , logFile(NULL)
+    , optionsChanged(false)
+    , resultDepth(0)
+    , resultBestMoveChanged(false)
+    , resultScoreSwing(0)
+    , nodeLimit(0)
+    , moveTime(0)
+    , earlyStopThreshold(0)
+    , earlyStopIterations(0)
+    , searchDepth(0)
+    , judged(0)
+    , cache(NULL)
+    , cacheKey(0)
+    , cacheParams(0)
+    , cacheHit(false)
+    , memo(NULL)
+    , memoOwner(false)
 {
     // Open debug log file only in debug mode
     if (debugMode) {
-        logFile = fopen("stockfish_debug.log", "w");
+        logFile = fopen(logFileName("stockfish_debug", id).c_str(), "w");
         if (logFile) {
             fprintf(logFile, "=== Stockfish Communication Log ===\n");
             fflush(logFile);
@@ -85,9 +213,9 @@ bool StockfishEngine::initialize() {
 
     fdToEngine = pipeToEngine[1];
     fdFromEngine = pipeFromEngine[0];
+    reader.reset(fdFromEngine);
 
-    // Initialize UCI
-    usleep(100000);  // 100ms delay
+    // Initialize UCI (no delays needed: the pipe buffers commands until Stockfish reads them)
     sendCommand("uci");
 
     // Wait for uciok (silently consume all output)
@@ -115,50 +243,39 @@ bool StockfishEngine::initialize() {
     }
 
     // Set number of threads
-    usleep(100000);  // 100ms delay
-    std::ostringstream threadsCmd;
-    threadsCmd << "setoption name Threads value " << threads;
-    sendCommand(threadsCmd.str());
+    setOption("Threads", threads);
+
+    // Set hash size (after Threads, which reallocates the table, so a large one is only allocated once)
+    if (hashMB > 0) {
+        setOption("Hash", hashMB);
+    }
 
     // Set MultiPV to get top N moves
-    usleep(100000);  // 100ms delay
-    std::ostringstream multiPVCmd;
-    multiPVCmd << "setoption name MultiPV value " << multiPV;
-    sendCommand(multiPVCmd.str());
+    setOption("MultiPV", multiPV);
 
     // Enable Stockfish internal debug logging (only in debug mode)
     if (debugMode) {
-        usleep(100000);  // 100ms delay
-        sendCommand("setoption name Debug Log File value stockfish_internal.log");
+        setOption("Debug Log File", logFileName("stockfish_internal", id));
     }
 
-    // Set to UCI mode
-    usleep(100000);  // 100ms delay
-    sendCommand("isready");
-
-    // Wait for readyok
-    while (true) {
-        line = readLine();
-        if (line.find("readyok") == 0) {
-            break;
-        }
-        if (line.empty()) {
-            std::cerr << "Error: Stockfish didn't respond to 'isready'" << std::endl;
-            return false;
-        }
+    // Wait until all options are applied
+    if (!waitUntilReady()) {
+        std::cerr << "Error: Stockfish didn't respond to 'isready'" << std::endl;
+        return false;
     }
 
     if (logFile) {
         fprintf(logFile, "\n=== Stockfish initialized successfully ===\n");
         if (debugMode) {
-            fprintf(logFile, "Internal Stockfish debug log: stockfish_internal.log\n");
+            fprintf(logFile, "Internal Stockfish debug log: %s\n", logFileName("stockfish_internal", id).c_str());
         }
         fprintf(logFile, "\n");
         fflush(logFile);
     }
 
     if (debugMode) {
-        std::cout << "Debug mode enabled: stockfish_debug.log, stockfish_internal.log" << std::endl;
+        std::cout << "Debug mode enabled: " << logFileName("stockfish_debug", id)
+                  << ", " << logFileName("stockfish_internal", id) << std::endl;
     }
 
     return true;
@@ -183,143 +300,158 @@ void StockfishEngine::terminate() {
 }
 
 bool StockfishEngine::sendCommand(const std::string& cmd) {
+    command.assign(cmd);
+    command += '\n';
+    return writeCommand();
+}
+
+bool StockfishEngine::writeCommand() {
     if (fdToEngine < 0) {
         return false;
     }
 
     // Log command with call stack info
     if (logFile) {
-        fprintf(logFile, ">>> SEND: %s (fdToEngine=%d)\n", cmd.c_str(), fdToEngine);
+        fprintf(logFile, ">>> SEND: %.*s (fdToEngine=%d)\n", (int)command.size() - 1, command.c_str(), fdToEngine);
         fflush(logFile);
     }
 
-    std::string cmdWithNewline = cmd + "\n";
-    ssize_t written = write(fdToEngine, cmdWithNewline.c_str(), cmdWithNewline.length());
+    // Multi-line commands (e.g. "position ...\ngo ...") go out in a single write;
+    // only retry if the pipe accepted part of it
+    size_t total = 0;
+    while (total < command.length()) {
+        ssize_t written = write(fdToEngine, command.c_str() + total, command.length() - total);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;
+        }
+        total += written;
+    }
+    stats.bytesWritten += total;
 
-    bool success = written == (ssize_t)cmdWithNewline.length();
+    bool success = total == command.length();
     if (logFile) {
-        fprintf(logFile, "    (written %zd bytes, success=%d, errno=%d)\n", written, success, errno);
+        fprintf(logFile, "    (written %zu bytes, success=%d, errno=%d)\n", total, success, errno);
         fflush(logFile);
     }
 
-    // Verify the write completed fully
-    if (written != (ssize_t)cmdWithNewline.length()) {
-        fprintf(logFile, "    WARNING: Partial write! Expected %zu, got %zd\n", cmdWithNewline.length(), written);
-        fflush(logFile);
+    return success;
+}
+
+void StockfishEngine::setOption(const std::string& name, const std::string& value) {
+    sendCommand("setoption name " + name + " value " + value);
+    optionsChanged = true;
+}
+
+void StockfishEngine::setOption(const std::string& name, int value) {
+    std::ostringstream str;
+    str << value;
+    setOption(name, str.str());
+}
+
+void StockfishEngine::clearHash() {
+    sendCommand("ucinewgame");
+    optionsChanged = true;
+    pliesSinceClear = 0;
+    stats.hashClears++;
+}
+
+void StockfishEngine::beginPly() {
+    if (hashClearInterval > 0 && pliesSinceClear >= hashClearInterval) {
+        clearHash();
     }
+    pliesSinceClear++;
+}
 
-    return success;
+bool StockfishEngine::syncOptions() {
+    if (!optionsChanged) {
+        return true;
+    }
+    if (!waitUntilReady()) {
+        std::cerr << "Warning: Stockfish not ready after option change" << std::endl;
+        return false;
+    }
+    return true;
 }
 
-std::string StockfishEngine::readLine() {
+bool StockfishEngine::readLineView(StringView& line) {
     if (fdFromEngine < 0) {
         if (logFile) {
             fprintf(logFile, "<<< ERROR: fdFromEngine < 0\n");
             fflush(logFile);
         }
-        return "";
+        return false;
     }
 
-    while (true) {
-        // Check if we have a complete line in the buffer
-        size_t newlinePos = readBuffer.find('\n');
-        if (newlinePos != std::string::npos) {
-            // Extract line and remove from buffer
-            std::string line = readBuffer.substr(0, newlinePos);
-            readBuffer = readBuffer.substr(newlinePos + 1);
-
-            // Log received line
-            if (logFile) {
-                fprintf(logFile, "<<< RECV: %s\n", line.c_str());
-                fflush(logFile);
-            }
-
-            return line;
-        }
-
-        // Need to read more data
-        fd_set readfds;
-        struct timeval timeout;
-        timeout.tv_sec = 60;
-        timeout.tv_usec = 0;
-
-        FD_ZERO(&readfds);
-        FD_SET(fdFromEngine, &readfds);
+    LineReader::Status status = reader.readLine(line, 60000);
 
-        int ret = select(fdFromEngine + 1, &readfds, NULL, NULL, &timeout);
-
-        if (ret == 0) {
-            if (logFile) {
-                fprintf(logFile, "<<< TIMEOUT after 60 seconds\n");
-                fflush(logFile);
-            }
-            std::cerr << "\nWarning: Stockfish timeout" << std::endl;
-            return "";
-        } else if (ret < 0) {
-            if (logFile) {
-                fprintf(logFile, "<<< ERROR: select() failed (errno=%d)\n", errno);
-                fflush(logFile);
-            }
-            std::cerr << "\nError: select() failed" << std::endl;
-            return "";
+    if (status == LineReader::LINE) {
+        // Log received line
+        if (logFile) {
+            fprintf(logFile, "<<< RECV: %.*s\n", (int)line.size, line.data);
+            fflush(logFile);
         }
+        return true;
+    }
 
-        // Read available data
-        char buffer[4096];
-        ssize_t n = read(fdFromEngine, buffer, sizeof(buffer) - 1);
-        if (n <= 0) {
-            if (logFile) {
-                fprintf(logFile, "<<< ERROR: read() returned %zd (errno=%d)\n", n, errno);
-                fflush(logFile);
-            }
-            // End of stream or error
-            if (!readBuffer.empty()) {
-                std::string line = readBuffer;
-                readBuffer.clear();
-                if (logFile) {
-                    fprintf(logFile, "<<< RECV (final): %s\n", line.c_str());
-                    fflush(logFile);
-                }
-                return line;
-            }
-            return "";
+    if (status == LineReader::TIMEOUT) {
+        if (logFile) {
+            fprintf(logFile, "<<< TIMEOUT after 60 seconds\n");
+            fflush(logFile);
         }
-
-        buffer[n] = '\0';
-        readBuffer += std::string(buffer);
-
+        std::cerr << "\nWarning: Stockfish timeout" << std::endl;
+    } else if (status == LineReader::FAILED) {
         if (logFile) {
-            fprintf(logFile, "    (read %zd bytes into buffer, buffer now has %zu chars)\n", n, readBuffer.size());
+            fprintf(logFile, "<<< ERROR: poll() failed (errno=%d)\n", errno);
             fflush(logFile);
         }
+        std::cerr << "\nError: poll() failed" << std::endl;
+    } else if (logFile) {
+        fprintf(logFile, "<<< ERROR: end of stream (errno=%d)\n", errno);
+        fflush(logFile);
     }
+
+    line = StringView();
+    return false;
 }
 
-void StockfishEngine::setPosition(const std::string& fen, const std::vector<std::string>& moves) {
-    std::ostringstream cmd;
+std::string StockfishEngine::readLine() {
+    StringView line;
+    if (!readLineView(line)) {
+        return "";
+    }
+    return line.str();
+}
 
+void StockfishEngine::appendPositionCommand(std::string& cmd, const std::string& fenOrStartpos,
+                                            const std::vector<PackedMove>& moves) {
     // If fen is "startpos", use startpos instead of FEN notation
-    if (fen == "startpos") {
-        cmd << "position startpos";
+    if (fenOrStartpos == "startpos") {
+        cmd += "position startpos";
     } else {
-        cmd << "position fen " << fen;
+        cmd += "position fen ";
+        cmd += fenOrStartpos;
     }
 
     if (!moves.empty()) {
-        cmd << " moves";
+        cmd += " moves";
         for (size_t i = 0; i < moves.size(); i++) {
-            cmd << " " << moves[i];
+            cmd += ' ';
+            Move::appendPackedUci(cmd, moves[i]);
         }
     }
+}
 
-    usleep(50000);  // 50ms delay
-    sendCommand(cmd.str());
-
-    // Wait for position to be set before continuing
-    usleep(50000);  // 50ms delay
-    if (!waitUntilReady()) {
-        std::cerr << "Warning: Stockfish not ready after setPosition" << std::endl;
-    }
+void StockfishEngine::setPosition(const std::string& fen, const std::vector<PackedMove>& moves) {
+    // No isready round-trip needed: UCI processes stdin in order, so a following
+    // "go" always sees this position
+    syncOptions();
+    command.clear();
+    appendPositionCommand(command, fen, moves);
+    command += '\n';
+    writeCommand();
 }
 
 bool StockfishEngine::waitUntilReady() {
@@ -330,124 +462,89 @@ bool StockfishEngine::waitUntilReady() {
 
     sendCommand("isready");
 
-    std::string line;
+    StringView line;
     // Read ALL lines until we get "readyok" - no limit!
     // This prevents pipe buffer overflow
-    while (true) {
-        line = readLine();
-        if (line.find("readyok") == 0) {
+    while (readLineView(line)) {
+        if (line.startsWith("readyok")) {
             if (logFile) {
                 fprintf(logFile, "=== Stockfish is ready ===\n\n");
                 fflush(logFile);
             }
+            optionsChanged = false;
             return true;
         }
-        if (line.empty()) {
-            if (logFile) {
-                fprintf(logFile, "=== ERROR: No readyok received (timeout or connection lost) ===\n\n");
-                fflush(logFile);
-            }
-            return false;
-        }
         // Continue reading - no limit on number of lines!
     }
+
+    if (logFile) {
+        fprintf(logFile, "=== ERROR: No readyok received (timeout or connection lost) ===\n\n");
+        fflush(logFile);
+    }
+    return false;
 }
 
 ScoreResult StockfishEngine::getBestMove(int depth) {
     std::ostringstream cmd;
     cmd << "go depth " << depth;
-    usleep(50000);  // 50ms delay
     sendCommand(cmd.str());
 
     return parseSearchResult();
 }
 
-ScoreResult StockfishEngine::evaluateMove(const std::string& fenOrStartpos, const std::vector<std::string>& movesToPosition, const std::string& moveToEvaluate, int depth) {
+ScoreResult StockfishEngine::evaluateMove(const std::string& fenOrStartpos, const std::vector<PackedMove>& movesToPosition, PackedMove moveToEvaluate, int depth) {
     // Set position after the move (checkscore.py approach)
-    std::ostringstream cmd;
-
-    // Use startpos or FEN
-    if (fenOrStartpos == "startpos") {
-        cmd << "position startpos";
-    } else {
-        cmd << "position fen " << fenOrStartpos;
-    }
-
-    // Add all moves to get to the position, plus the move to evaluate
-    cmd << " moves";
-    for (size_t i = 0; i < movesToPosition.size(); i++) {
-        cmd << " " << movesToPosition[i];
-    }
-    cmd << " " << moveToEvaluate;
-
-    usleep(50000);  // 50ms delay
-    sendCommand(cmd.str());
-
-    // Wait for position to be processed
-    usleep(50000);  // 50ms delay
-    if (!waitUntilReady()) {
-        std::cerr << "Warning: Stockfish not ready after setPosition in evaluateMove" << std::endl;
-    }
-
-    // Search
-    cmd.str("");
-    cmd << "go depth " << depth;
-    usleep(50000);  // 50ms delay
-    sendCommand(cmd.str());
+    std::vector<PackedMove> moves(movesToPosition);
+    moves.push_back(moveToEvaluate);
+
+    // Position and search in one write
+    syncOptions();
+    command.clear();
+    appendPositionCommand(command, fenOrStartpos, moves);
+    command += "\ngo depth ";
+    command += std::to_string(depth);
+    appendSearchLimits();
+    command += '\n';
+    writeCommand();
 
     return parseSearchResult();
 }
 
 ScoreResult StockfishEngine::parseSearchResult() {
     ScoreResult result;
-    std::string line;
+    StringView line;
+    UciInfo info;
 
     while (true) {
-        line = readLine();
-
-        // Check for empty line (timeout or error)
-        if (line.empty()) {
+        // Check for end of output (timeout or error)
+        if (!readLineView(line)) {
             std::cerr << "\nError: No response from Stockfish, returning empty result" << std::endl;
             break;
         }
 
-        if (line.find("info ") == 0) {
+        if (parseInfoLine(line, info)) {
             // Parse score from info line
-            size_t cpPos = line.find(" cp ");
-            if (cpPos != std::string::npos) {
-                std::istringstream iss(line.substr(cpPos + 4));
-                iss >> result.scoreCP;
-                result.isMate = false;
-            }
-
-            size_t matePos = line.find(" mate ");
-            if (matePos != std::string::npos) {
-                std::istringstream iss(line.substr(matePos + 6));
-                iss >> result.mateInN;
-                result.isMate = true;
-                // Convert mate to large score
-                result.scoreCP = (result.mateInN > 0) ? 10000 : -10000;
+            if (info.hasScore) {
+                result.scoreCP = info.scoreCP;
+                result.isMate = info.isMate;
+                if (info.isMate) {
+                    result.mateInN = info.mateInN;
+                }
             }
 
             // Parse best move from pv
-            size_t pvPos = line.find(" pv ");
-            if (pvPos != std::string::npos) {
-                std::istringstream iss(line.substr(pvPos + 4));
-                iss >> result.bestMove;
+            if (!info.pvMove.empty()) {
+                result.bestMove = Move::uciToPacked(info.pvMove);
             }
+            continue;
         }
 
-        if (line.find("bestmove ") == 0) {
-            // Parse best move
-            std::istringstream iss(line.substr(9));
-            std::string move;
-            iss >> move;
-
+        StringView bestMove = parseBestMove(line);
+        if (!bestMove.empty()) {
             // Only update if we didn't get it from pv
-            if (result.bestMove.empty()) {
-                result.bestMove = move;
+            if (result.bestMove == 0) {
+                result.bestMove = Move::uciToPacked(bestMove);
             }
-
             break;
         }
     }
@@ -457,97 +554,261 @@ ScoreResult StockfishEngine::parseSearchResult() {
 
 std::vector<MoveScore> StockfishEngine::parseMultiPVResult() {
     std::vector<MoveScore> results;
-    std::string line;
-    int targetDepth = -1;
+    StringView line;
+    UciInfo info;
+    long long nodes = 0;
+    bool stopSent = false;
+    int lastVerdict = 0;
+    int stableIterations = 0;
 
-    while (true) {
-        line = readLine();
+    aggregator.reset();
 
-        // Check for empty line (timeout or error)
-        if (line.empty()) {
+    while (true) {
+        // Check for end of output (timeout or error)
+        if (!readLineView(line)) {
             std::cerr << "\nError: No response from Stockfish during MultiPV parsing" << std::endl;
             break;
         }
 
-        if (line.find("info ") == 0) {
-            // Parse MultiPV info lines
-            size_t multiPVPos = line.find(" multipv ");
-            if (multiPVPos == std::string::npos) {
-                continue;  // Skip non-MultiPV info lines
+        if (line.startsWith("bestmove ")) {
+            break;
+        }
+
+        // Lines below the deepest complete iteration can't improve the result
+        // and are rejected right after their depth token
+        if (!parseInfoLine(line, info, aggregator.getCompleteDepth())) {
+            continue;
+        }
+        if (info.nodes > nodes) {
+            nodes = info.nodes;
+        }
+        if (info.multiPV == 0) {
+            continue;  // Skip non-MultiPV info lines
+        }
+
+        int completeDepth = aggregator.getCompleteDepth();
+        aggregator.add(info);
+
+        // A new complete iteration: stop once the verdict on the judged move held
+        // long enough (the search then ends with the usual bestmove)
+        if (judged != 0 && !stopSent && aggregator.getCompleteDepth() > completeDepth) {
+            int verdict = judgedVerdict();
+            stableIterations = (verdict != 0 && verdict == lastVerdict) ? stableIterations + 1 : 1;
+            lastVerdict = verdict;
+            if (verdict != 0 && stableIterations >= earlyStopIterations &&
+                aggregator.getCompleteDepth() * 2 >= searchDepth && aggregator.getCompleteDepth() < searchDepth) {
+                sendCommand("stop");
+                stopSent = true;
             }
+        }
+    }
 
-            // Extract depth
-            size_t depthPos = line.find(" depth ");
-            if (depthPos != std::string::npos) {
-                std::istringstream iss(line.substr(depthPos + 7));
-                int depth;
-                iss >> depth;
+    stats.nodes += nodes;
 
-                // Set target depth from first MultiPV line
-                if (targetDepth == -1) {
-                    targetDepth = depth;
-                }
+    // Closes the last iteration, so the depth below is the one the result reports
+    aggregator.finish(results);
+    if (stopSent) {
+        stats.earlyStops++;
+        stats.earlyStopDepths += aggregator.getCompleteDepth();
+    }
+    return results;
+}
 
-                // Only process lines from the final depth
-                if (depth != targetDepth) {
-                    continue;
-                }
-            }
+void StockfishEngine::startAnalysis(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                                    const std::vector<PackedMove>& searchMoves, PackedMove judgedMove) {
+    searchStart = std::chrono::steady_clock::now();
+    searchDepth = depth;
+    judged = earlyStopIterations > 0 ? judgedMove : 0;
+
+    // Answer from the memo (another game reached this position) or the cache
+    // if this position was searched with the same settings before
+    cacheHit = false;
+    memoOwner = false;
+    cacheKey = 0;
+    if (cache != NULL || memo != NULL) {
+        cacheKey = positionKey(fenOrStartpos, moves);
+        cacheParams = searchParams(depth, searchMoves);
+    }
+    resultScoreSwing = 0;  // Not kept by the memo and the cache
+    if (cacheKey != 0 && memo != NULL && memo->isShared(cacheKey)) {
+        if (memo->acquire(cacheKey, cacheParams, cachedResults, resultDepth, resultBestMoveChanged)) {
+            cacheHit = true;
+            return;
+        }
+        memoOwner = true;
+    }
+    if (cacheKey != 0 && cache != NULL &&
+        cache->lookup(cacheKey, cacheParams, cachedResults, resultDepth, resultBestMoveChanged)) {
+        cacheHit = true;
+        if (memoOwner) {
+            memo->publish(cacheKey, cacheParams, cachedResults, resultDepth, resultBestMoveChanged);
+            memoOwner = false;
+        }
+        return;
+    }
 
-            MoveScore moveScore;
+    // Position and search go out back-to-back in one write
+    syncOptions();
+    command.clear();
+    appendPositionCommand(command, fenOrStartpos, moves);
+    command += "\ngo depth ";
+    command += std::to_string(depth);
+    appendSearchLimits();
+    if (!searchMoves.empty()) {
+        command += " searchmoves";
+        for (size_t i = 0; i < searchMoves.size(); i++) {
+            command += ' ';
+            Move::appendPackedUci(command, searchMoves[i]);
+        }
+    }
+    command += '\n';
+    writeCommand();
+}
 
-            // Extract MultiPV index
-            std::istringstream issMultiPV(line.substr(multiPVPos + 9));
-            issMultiPV >> moveScore.multiPVIndex;
+std::vector<MoveScore> StockfishEngine::finishAnalysis() {
+    std::vector<MoveScore> results;
+    if (cacheHit) {
+        cacheHit = false;
+        results.swap(cachedResults);
+        return results;
+    }
 
-            // Parse score
-            size_t cpPos = line.find(" cp ");
-            if (cpPos != std::string::npos) {
-                std::istringstream iss(line.substr(cpPos + 4));
-                iss >> moveScore.scoreCP;
-                moveScore.isMate = false;
-            }
+    // Parse and return all MultiPV results
+    results = parseMultiPVResult();
+    resultDepth = aggregator.getCompleteDepth();
+    resultBestMoveChanged = aggregator.getBestMoveChanged();
+    resultScoreSwing = aggregator.getScoreSwing();
+    if (cache != NULL && cacheKey != 0) {
+        cache->store(cacheKey, cacheParams, results, resultDepth, resultBestMoveChanged);
+    }
+    if (memoOwner) {
+        memo->publish(cacheKey, cacheParams, results, resultDepth, resultBestMoveChanged);
+        memoOwner = false;
+    }
 
-            size_t matePos = line.find(" mate ");
-            if (matePos != std::string::npos) {
-                std::istringstream iss(line.substr(matePos + 6));
-                iss >> moveScore.mateInN;
-                moveScore.isMate = true;
-                // Convert mate to large score
-                moveScore.scoreCP = (moveScore.mateInN > 0) ? 10000 : -10000;
-            }
+    stats.searches++;
+    stats.searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
+    stats.bytesRead = reader.getBytesRead();
+    stats.linesRead = reader.getLinesRead();
 
-            // Parse move from pv
-            size_t pvPos = line.find(" pv ");
-            if (pvPos != std::string::npos) {
-                std::istringstream iss(line.substr(pvPos + 4));
-                iss >> moveScore.move;
-            }
+    return results;
+}
 
-            // Store this move score
-            if (!moveScore.move.empty()) {
-                results.push_back(moveScore);
-            }
+void StockfishEngine::setMultiPV(int numMultiPV) {
+    if (numMultiPV != multiPV) {
+        multiPV = numMultiPV;
+        setOption("MultiPV", multiPV);
+    }
+}
+
+void StockfishEngine::setMultiPVLadder(const std::vector<int>& ladder) {
+    multiPVLadder = ladder;
+    stats.tierHits.assign(ladder.size(), 0);
+    if (!ladder.empty()) {
+        setMultiPV(ladder[0]);
+    }
+}
+
+static bool containsMove(const std::vector<MoveScore>& results, PackedMove move) {
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].move == move) {
+            return true;
         }
+    }
+    return false;
+}
 
-        if (line.find("bestmove ") == 0) {
-            break;
+void StockfishEngine::escalateMultiPV(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                                      PackedMove targetMove, std::vector<MoveScore>& results) {
+    if (multiPVLadder.empty()) {
+        return;
+    }
+
+    size_t tier = 0;
+    while (!containsMove(results, targetMove) && tier + 1 < multiPVLadder.size() && (int)results.size() >= multiPV) {
+        tier++;
+        setMultiPV(multiPVLadder[tier]);
+        results = analyzePosition(fenOrStartpos, moves, depth, std::vector<PackedMove>(), targetMove);
+    }
+
+    if (containsMove(results, targetMove)) {
+        stats.tierHits[tier]++;
+    } else {
+        stats.tierMisses++;
+    }
+
+    setMultiPV(multiPVLadder[0]);
+}
+
+uint64_t StockfishEngine::positionKey(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves) {
+    Board board;
+    if (fenOrStartpos != "startpos") {
+        board.setFromFen(fenOrStartpos);
+    }
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (!board.makeMove(Move::fromPacked(moves[i]))) {
+            return 0;
         }
     }
+    return board.getHash();
+}
 
-    return results;
+uint64_t StockfishEngine::searchParams(int depth, const std::vector<PackedMove>& searchMoves) const {
+    // Everything besides the position that changes the result of a search
+    uint64_t params = (uint64_t)depth | ((uint64_t)multiPV << 8) | ((uint64_t)aggregator.getCapturePV() << 20);
+    for (size_t i = 0; i < searchMoves.size(); i++) {
+        params = params * 0x100000001B3ULL + searchMoves[i] + 1;
+    }
+
+    // An early stopped search depends on the judged move and the verdict bands
+    if (judged != 0) {
+        params = params * 0x100000001B3ULL + judged;
+        params = params * 0x100000001B3ULL + ((uint64_t)earlyStopThreshold << 8 | earlyStopIterations);
+    }
+
+    // Node limits are reproducible; movetime is not, and varies from search to
+    // search, so timed results only share entries with other timed results
+    if (nodeLimit > 0) {
+        params = params * 0x100000001B3ULL + (uint64_t)nodeLimit;
+    }
+    if (moveTime > 0) {
+        params = params * 0x100000001B3ULL + 1;
+    }
+    return params;
 }
 
-std::vector<MoveScore> StockfishEngine::analyzePosition(const std::string& fenOrStartpos, const std::vector<std::string>& moves, int depth) {
-    // Set the position
-    setPosition(fenOrStartpos, moves);
+void StockfishEngine::appendSearchLimits() {
+    if (nodeLimit > 0) {
+        command += " nodes ";
+        command += std::to_string(nodeLimit);
+    }
+    if (moveTime > 0) {
+        command += " movetime ";
+        command += std::to_string(moveTime);
+    }
+}
 
-    // Start search with MultiPV
-    std::ostringstream cmd;
-    cmd << "go depth " << depth;
-    usleep(50000);  // 50ms delay
-    sendCommand(cmd.str());
+void StockfishEngine::setEarlyStop(int thresholdCP, int stableIterations) {
+    earlyStopThreshold = thresholdCP;
+    earlyStopIterations = stableIterations;
+}
 
-    // Parse and return all MultiPV results
-    return parseMultiPVResult();
+int StockfishEngine::judgedVerdict() const {
+    int loss = aggregator.getCompleteLoss(judged, multiPV);
+    if (loss < 0) {
+        return 0;
+    }
+    if (loss * 2 <= earlyStopThreshold) {
+        return -1;
+    }
+    if (loss * 2 >= earlyStopThreshold * 3) {
+        return 1;
+    }
+    return 0;
+}
+
+std::vector<MoveScore> StockfishEngine::analyzePosition(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                                                        const std::vector<PackedMove>& searchMoves, PackedMove judgedMove) {
+    startAnalysis(fenOrStartpos, moves, depth, searchMoves, judgedMove);
+    return finishAnalysis();
 }
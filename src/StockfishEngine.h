@@ -1,31 +1,133 @@
 #ifndef STOCKFISH_ENGINE_H
 #define STOCKFISH_ENGINE_H
 
+#include "LineReader.h"
+#include "Move.h"
+#include "StringView.h"
+#include "UciInfo.h"
 #include <string>
 #include <vector>
+#include <chrono>
+#include <stdint.h>
+
+class EvalCache;
+class PositionMemo;
 
 struct ScoreResult {
-    std::string bestMove;
+    PackedMove bestMove;
     int scoreCP;      // Centipawns (from side to move perspective)
     bool isMate;
     int mateInN;
 
-    ScoreResult() : scoreCP(0), isMate(false), mateInN(0) {}
+    ScoreResult() : bestMove(0), scoreCP(0), isMate(false), mateInN(0) {}
 };
 
 struct MoveScore {
-    std::string move;
+    PackedMove move;
     int scoreCP;
     bool isMate;
     int mateInN;
     int multiPVIndex;  // 1-based index from MultiPV
+    std::string pv;    // Full principal variation (only if PV capture is enabled)
+
+    MoveScore() : move(0), scoreCP(0), isMate(false), mateInN(0), multiPVIndex(0) {}
+};
+
+// Collects the MultiPV lines of one search. Stockfish reports all PVs as one
+// block of lines per print; a block whose lines all carry the same depth (and
+// no bound) is a completely reported iteration. Each block is written into a
+// fixed array indexed by multiPVIndex and swapped with the last complete
+// iteration when it is complete, so nothing grows across depths.
+class MultiPVAggregator {
+public:
+    MultiPVAggregator();
+
+    // Start a new search
+    void reset();
+
+    // Feed an info line that has a multipv field
+    void add(const UciInfo& info);
+
+    // Call at bestmove; returns the deepest completely reported iteration
+    // (one MoveScore per PV, sorted by multiPVIndex)
+    void finish(std::vector<MoveScore>& results);
+
+    // Depth of the deepest complete iteration so far (0 if none)
+    int getCompleteDepth() const { return completeDepth; }
+
+    // True if the best move of the last complete iteration differs from the one before
+    bool getBestMoveChanged() const { return bestMoveChanged; }
 
-    MoveScore() : scoreCP(0), isMate(false), mateInN(0), multiPVIndex(0) {}
+    // Largest change of the best score between two consecutive complete
+    // iterations (mate scores excluded), a measure of how volatile the position is
+    int getScoreSwing() const { return scoreSwing; }
+
+    // Centipawn loss of move against the best line of the deepest complete
+    // iteration. -1 if there is none yet, or if move is not among its lines but
+    // could be beyond them (all requestedLines lines were listed); 9999 if the
+    // lines cover every legal move and move is not among them.
+    int getCompleteLoss(PackedMove move, int requestedLines) const;
+
+    // Keep the full PV of every line (off by default)
+    void setCapturePV(bool enable) { capturePV = enable; }
+    bool getCapturePV() const { return capturePV; }
+
+private:
+    std::vector<MoveScore> block;     // Lines of the block being received
+    std::vector<MoveScore> complete;  // Deepest complete iteration
+    int blockCount;      // Highest multiPVIndex in the current block
+    int blockDepth;      // Depth of the current block (-1 if depths are mixed)
+    bool blockHasBound;
+    int completeCount;
+    int completeDepth;
+    bool bestMoveChanged;
+    int scoreSwing;
+    bool capturePV;
+
+    void closeBlock();
+};
+
+// Per-engine counters for measuring protocol overhead and throughput
+struct EngineStats {
+    long searches;         // Completed analyzePosition() calls
+    double searchSeconds;  // Wall time spent in analyzePosition() (send + search + parse)
+    unsigned long long bytesRead;  // Engine output consumed by the line reader
+    unsigned long long linesRead;
+    unsigned long long bytesWritten;  // Commands sent to the engine
+    unsigned long long nodes;      // Nodes searched (last "nodes" of each search)
+    long earlyStops;               // Searches stopped once the verdict was settled
+    long earlyStopDepths;          // Sum of the depths they were stopped at
+    long hashClears;               // ucinewgame commands sent
+    std::vector<long> tierHits;  // Adaptive MultiPV: positions settled at each ladder tier
+    long tierMisses;             // Adaptive MultiPV: target move not found at any tier
+
+    EngineStats() : searches(0), searchSeconds(0.0), bytesRead(0), linesRead(0), bytesWritten(0), nodes(0), earlyStops(0), earlyStopDepths(0),
+                    hashClears(0), tierMisses(0) {}
+
+    void add(const EngineStats& other) {
+        searches += other.searches;
+        searchSeconds += other.searchSeconds;
+        bytesRead += other.bytesRead;
+        linesRead += other.linesRead;
+        bytesWritten += other.bytesWritten;
+        nodes += other.nodes;
+        earlyStops += other.earlyStops;
+        earlyStopDepths += other.earlyStopDepths;
+        hashClears += other.hashClears;
+        if (tierHits.size() < other.tierHits.size()) {
+            tierHits.resize(other.tierHits.size(), 0);
+        }
+        for (size_t i = 0; i < other.tierHits.size(); i++) {
+            tierHits[i] += other.tierHits[i];
+        }
+        tierMisses += other.tierMisses;
+    }
 };
 
 class StockfishEngine {
 public:
-    StockfishEngine(const std::string& path, int depth, int numThreads = 1, int numMultiPV = 200, bool enableDebug = false);
+    // engineId distinguishes pooled engines (used for debug log file names)
+    StockfishEngine(const std::string& path, int depth, int numThreads = 1, int numMultiPV = 200, bool enableDebug = false, int engineId = 0);
     ~StockfishEngine();
 
     bool initialize();
@@ -33,11 +135,87 @@ public:
 
     // Set current position
     // If fen == "startpos", uses startpos instead of FEN notation
-    void setPosition(const std::string& fen, const std::vector<std::string>& moves = std::vector<std::string>());
+    void setPosition(const std::string& fen, const std::vector<PackedMove>& moves = std::vector<PackedMove>());
 
     // Analyze position with MultiPV and return all top moves with their scores
     // Returns moves sorted by score (best first)
-    std::vector<MoveScore> analyzePosition(const std::string& fenOrStartpos, const std::vector<std::string>& moves, int depth);
+    // searchMoves restricts the search to the given root moves ("go ... searchmoves")
+    // judgedMove is the move whose verdict may end the search early (see setEarlyStop())
+    std::vector<MoveScore> analyzePosition(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                                           const std::vector<PackedMove>& searchMoves = std::vector<PackedMove>(),
+                                           PackedMove judgedMove = 0);
+
+    // Pipelined form of analyzePosition(): startAnalysis() writes "position" and "go"
+    // in a single write and returns immediately, finishAnalysis() reads up to bestmove.
+    // Callers can queue the next search right after finishAnalysis() and process the
+    // results while Stockfish is already searching.
+    void startAnalysis(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                       const std::vector<PackedMove>& searchMoves = std::vector<PackedMove>(),
+                       PackedMove judgedMove = 0);
+    std::vector<MoveScore> finishAnalysis();
+
+    // Depth of the last complete iteration of the last search
+    int lastDepth() const { return resultDepth; }
+
+    // Whether the best move changed between the last two iterations of the last search
+    bool bestMoveChanged() const { return resultBestMoveChanged; }
+
+    // Score swing between iterations of the last search (see MultiPVAggregator)
+    int lastScoreSwing() const { return resultScoreSwing; }
+
+    // Search budgets added to "go depth": a node limit for every search and a
+    // movetime in milliseconds for the following searches (0 = no limit).
+    // Stockfish stops at whichever limit is reached first.
+    void setNodes(long long limit) { nodeLimit = limit; }
+    void setMoveTime(int ms) { moveTime = ms; }
+
+    // Stockfish hash table size in MB, set by initialize() (0 = Stockfish's default)
+    void setHashSize(int mb) { hashMB = mb; }
+
+    // Clear the hash with "ucinewgame" (only while no search is pending). The
+    // next command waits for readyok, since Stockfish clears the table first.
+    void clearHash();
+
+    // Clear the hash after every plies plies counted by beginPly() (0 = never);
+    // beginPly() is called before the first search of each ply
+    void setHashClearInterval(int plies) { hashClearInterval = plies; }
+    void beginPly();
+
+    // Consult the cache before each search and store the results after it
+    // (NULL disables caching). Results are keyed by the Zobrist key of the
+    // searched position, so transpositions share an entry.
+    void setCache(EvalCache* evalCache) { cache = evalCache; }
+
+    // Share the searches of positions that several games reach with the other
+    // engines of this run (NULL disables sharing); consulted before the cache
+    void setMemo(PositionMemo* positionMemo) { memo = positionMemo; }
+
+    // Capture the full PV of each line in MoveScore::pv
+    void setCapturePV(bool enable) { aggregator.setCapturePV(enable); }
+
+    // Stop a search with a judged move once its verdict is settled: after each
+    // complete iteration the move counts as good if it loses at most half of
+    // thresholdCP against the best line, as a blunder if it loses at least one
+    // and a half times thresholdCP, and as undecided otherwise. Once the same
+    // verdict held for stableIterations iterations in a row, and at least half
+    // of the requested depth is reached, "stop" is sent. A move outside the
+    // listed lines stays undecided unless they cover every legal move, so a
+    // narrow MultiPV search always runs to full depth before "not in top N".
+    // 0 disables.
+    void setEarlyStop(int thresholdCP, int stableIterations);
+
+    // Adaptive MultiPV: results of a search at the first ladder tier are
+    // re-searched at the next tiers until targetMove shows up. Escalation stops
+    // at the last tier or once Stockfish lists fewer moves than requested (all
+    // legal moves are then included). The hash is kept warm between tiers and
+    // MultiPV is reset to the first tier afterwards.
+    void setMultiPVLadder(const std::vector<int>& ladder);
+    void escalateMultiPV(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves, int depth,
+                         PackedMove targetMove, std::vector<MoveScore>& results);
+
+    // Change a UCI option; the next command waits for isready/readyok first
+    void setOption(const std::string& name, const std::string& value);
+    void setOption(const std::string& name, int value);
 
     // Get best move from current position (deprecated - use analyzePosition instead)
     ScoreResult getBestMove(int depth);
@@ -46,27 +224,74 @@ public:
     // If fenOrStartpos == "startpos", uses startpos, otherwise uses FEN notation
     // movesToPosition: moves to reach the position before moveToEvaluate
     // moveToEvaluate: the move to evaluate
-    ScoreResult evaluateMove(const std::string& fenOrStartpos, const std::vector<std::string>& movesToPosition, const std::string& moveToEvaluate, int depth);
+    ScoreResult evaluateMove(const std::string& fenOrStartpos, const std::vector<PackedMove>& movesToPosition, PackedMove moveToEvaluate, int depth);
+
+    const EngineStats& getStats() const { return stats; }
 
 private:
     std::string stockfishPath;
     int defaultDepth;
     int threads;
-    int multiPV;
+    int hashMB;        // 0 = Stockfish default
+    int hashClearInterval;
+    int pliesSinceClear;
+    int multiPV;       // MultiPV currently set in Stockfish
+    std::vector<int> multiPVLadder;
     bool debugMode;
+    int id;
 
     // Process communication
     int pid;
     int fdToEngine;    // File descriptor to write to Stockfish
     int fdFromEngine;  // File descriptor to read from Stockfish
-    std::string readBuffer;  // Buffer for partial lines
+    LineReader reader;       // Buffered lines from Stockfish
+    MultiPVAggregator aggregator;
     FILE* logFile;     // Debug log file
+    EngineStats stats;
+    bool optionsChanged;  // setoption sent since the last readyok
+    std::chrono::steady_clock::time_point searchStart;
+    int resultDepth;             // lastDepth() of the last search
+    bool resultBestMoveChanged;  // bestMoveChanged() of the last search
+    int resultScoreSwing;        // lastScoreSwing() of the last search
+    long long nodeLimit;
+    int moveTime;
+
+    // Early stop (see setEarlyStop())
+    int earlyStopThreshold;
+    int earlyStopIterations;
+    int searchDepth;             // Requested depth of the pending search
+    PackedMove judged;           // Judged move of the pending search (0 = none)
+
+    // Evaluation cache (not owned)
+    EvalCache* cache;
+    uint64_t cacheKey;           // Position key of the pending search (0 = not cacheable)
+    uint64_t cacheParams;        // Search parameters of the pending search
+    bool cacheHit;               // The pending search was answered from the cache or memo
+    std::vector<MoveScore> cachedResults;
+
+    // Shared positions of this run (not owned)
+    PositionMemo* memo;
+    bool memoOwner;              // The pending search must be published to the memo
+
+    std::string command;         // Command being sent (reused, so sending does not allocate)
 
     bool sendCommand(const std::string& cmd);
+    bool writeCommand();         // Send command, which ends with a newline
     std::string readLine();
+    bool readLineView(StringView& line);  // Zero-copy; view valid until the next read
     bool waitUntilReady();  // Send isready and wait for readyok
+    bool syncOptions();     // waitUntilReady() only if options changed
+    void setMultiPV(int numMultiPV);
+    static void appendPositionCommand(std::string& cmd, const std::string& fenOrStartpos, const std::vector<PackedMove>& moves);
+    static uint64_t positionKey(const std::string& fenOrStartpos, const std::vector<PackedMove>& moves);
+    uint64_t searchParams(int depth, const std::vector<PackedMove>& searchMoves) const;
+    void appendSearchLimits();   // Append node and movetime limits to the go command
     ScoreResult parseSearchResult();
     std::vector<MoveScore> parseMultiPVResult();  // Parse MultiPV search results
+
+    // Verdict on the judged move from the deepest complete iteration: -1 good,
+    // 1 blunder, 0 undecided (see setEarlyStop())
+    int judgedVerdict() const;
 };
 
 #endif // STOCKFISH_ENGINE_H
@@ -0,0 +1,95 @@
+#include "StringPool.h"
+
+StringPool& StringPool::shared() {
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool()
+    : block(NULL)
+    , blockUsed(BLOCK_SIZE)
+    , bytes(0)
+{
+}
+
+StringPool::~StringPool() {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        delete[] blocks[i];
+    }
+}
+
+size_t StringPool::Hash::operator()(const StringView& text) const {
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < text.size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(text.data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+StringView StringPool::intern(const StringView& text) {
+    if (text.empty()) {
+        return StringView();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::unordered_set<StringView, Hash>::const_iterator it = index.find(text);
+    if (it != index.end()) {
+        return *it;
+    }
+    return add(text);
+}
+
+bool StringPool::tryIntern(const StringView& text, size_t limit, StringView& pooled) {
+    if (text.empty()) {
+        pooled = StringView();
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::unordered_set<StringView, Hash>::const_iterator it = index.find(text);
+    if (it != index.end()) {
+        pooled = *it;
+        return true;
+    }
+    if (bytes >= limit) {
+        return false;
+    }
+    pooled = add(text);
+    return true;
+}
+
+StringView StringPool::add(const StringView& text) {
+    char* copy;
+    if (text.size > BLOCK_SIZE / 4) {
+        // Long strings get a block of their own
+        copy = new char[text.size];
+        blocks.push_back(copy);
+    } else {
+        if (text.size > BLOCK_SIZE - blockUsed) {
+            block = new char[BLOCK_SIZE];
+            blocks.push_back(block);
+            blockUsed = 0;
+        }
+        copy = block + blockUsed;
+        blockUsed += text.size;
+    }
+    memcpy(copy, text.data, text.size);
+    bytes += text.size;
+
+    StringView pooled(copy, text.size);
+    index.insert(pooled);
+    return pooled;
+}
+
+size_t StringPool::getCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
+
+size_t StringPool::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
@@ -0,0 +1,57 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include "StringView.h"
+#include <stddef.h>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+// Append-only store of distinct strings (PGN tag names and recurring tag
+// values such as player names and events). Each string is stored once in
+// large blocks and kept until the pool is destroyed; the shared pool lives
+// until the program exits, so views returned by its intern() stay valid for
+// the life of every game referring to them. Thread-safe; parser threads use
+// pools of their own to stay off the shared pool's lock.
+class StringPool {
+public:
+    // The pool shared by all games
+    static StringPool& shared();
+
+    StringPool();
+    ~StringPool();
+
+    // View of the pooled copy of text (stored on first use)
+    StringView intern(const StringView& text);
+
+    // Like intern(), but new text is only stored while the pool holds less
+    // than limit bytes; returns false (and leaves pooled alone) otherwise
+    bool tryIntern(const StringView& text, size_t limit, StringView& pooled);
+
+    // Distinct strings and the bytes of their text
+    size_t getCount() const;
+    size_t getBytes() const;
+
+private:
+    struct Hash {
+        size_t operator()(const StringView& text) const;
+    };
+
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    mutable std::mutex mutex;
+    std::unordered_set<StringView, Hash> index;  // Views into blocks
+    std::vector<char*> blocks;                   // All allocations, freed at exit
+    char* block;                                 // Block short strings are appended to
+    size_t blockUsed;
+    size_t bytes;
+
+    // Store a copy of text that is not in the index yet (mutex held)
+    StringView add(const StringView& text);
+
+    // Non-copyable
+    StringPool(const StringPool&);
+    StringPool& operator=(const StringPool&);
+};
+
+#endif // STRING_POOL_H
@@ -0,0 +1,48 @@
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+#include <string>
+#include <cstring>
+#include <ostream>
+
+// Non-owning view of a character range (C++11 stand-in for std::string_view).
+// The viewed memory must outlive the view.
+struct StringView {
+    const char* data;
+    size_t size;
+
+    StringView() : data(""), size(0) {}
+    StringView(const char* str, size_t length) : data(str), size(length) {}
+    StringView(const char* str) : data(str), size(strlen(str)) {}
+    StringView(const std::string& str) : data(str.data()), size(str.size()) {}
+
+    bool empty() const { return size == 0; }
+    char operator[](size_t i) const { return data[i]; }
+
+    bool startsWith(const StringView& prefix) const {
+        return size >= prefix.size && memcmp(data, prefix.data, prefix.size) == 0;
+    }
+
+    StringView substr(size_t pos, size_t length = std::string::npos) const {
+        if (pos > size) {
+            pos = size;
+        }
+        if (length > size - pos) {
+            length = size - pos;
+        }
+        return StringView(data + pos, length);
+    }
+
+    std::string str() const { return std::string(data, size); }
+
+    bool operator==(const StringView& other) const {
+        return size == other.size && memcmp(data, other.data, size) == 0;
+    }
+    bool operator!=(const StringView& other) const { return !(*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StringView& text) {
+    return out.write(text.data, text.size);
+}
+
+#endif // STRING_VIEW_H
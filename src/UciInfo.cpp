@@ -0,0 +1,124 @@
+#include "UciInfo.h"
+
+namespace {
+
+// Cursor over space-separated tokens of a line
+struct Tokenizer {
+    const char* pos;
+    const char* end;
+
+    Tokenizer(const StringView& line) : pos(line.data), end(line.data + line.size) {}
+
+    bool next(StringView& token) {
+        while (pos < end && *pos == ' ') {
+            pos++;
+        }
+        if (pos == end) {
+            return false;
+        }
+        const char* start = pos;
+        while (pos < end && *pos != ' ') {
+            pos++;
+        }
+        token = StringView(start, pos - start);
+        return true;
+    }
+
+    // Everything after the current position (leading spaces skipped)
+    StringView rest() {
+        while (pos < end && *pos == ' ') {
+            pos++;
+        }
+        StringView result(pos, end - pos);
+        pos = end;
+        return result;
+    }
+
+    template <typename T>
+    bool nextNumber(T& value) {
+        StringView token;
+        if (!next(token)) {
+            return false;
+        }
+        size_t i = 0;
+        bool negative = false;
+        if (i < token.size && (token[i] == '-' || token[i] == '+')) {
+            negative = token[i] == '-';
+            i++;
+        }
+        if (i == token.size) {
+            return false;
+        }
+        T result = 0;
+        for (; i < token.size; i++) {
+            if (token[i] < '0' || token[i] > '9') {
+                return false;
+            }
+            result = result * 10 + (token[i] - '0');
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+};
+
+}  // namespace
+
+bool parseInfoLine(const StringView& line, UciInfo& info, int minDepth, int maxDepth) {
+    info.clear();
+
+    Tokenizer tok(line);
+    StringView token;
+    if (!tok.next(token) || token != "info") {
+        return false;
+    }
+
+    while (tok.next(token)) {
+        if (token == "depth") {
+            tok.nextNumber(info.depth);
+            if (info.depth < minDepth || info.depth > maxDepth) {
+                return false;
+            }
+        } else if (token == "multipv") {
+            tok.nextNumber(info.multiPV);
+        } else if (token == "score") {
+            StringView kind;
+            if (!tok.next(kind)) {
+                break;
+            }
+            if (kind == "cp") {
+                info.hasScore = tok.nextNumber(info.scoreCP);
+                info.isMate = false;
+            } else if (kind == "mate") {
+                info.hasScore = tok.nextNumber(info.mateInN);
+                info.isMate = true;
+                // Convert mate to large score
+                info.scoreCP = (info.mateInN > 0) ? 10000 : -10000;
+            }
+        } else if (token == "lowerbound" || token == "upperbound") {
+            info.isBound = true;
+        } else if (token == "nodes") {
+            tok.nextNumber(info.nodes);
+        } else if (token == "pv") {
+            info.pv = tok.rest();
+            Tokenizer pvTok(info.pv);
+            pvTok.next(info.pvMove);
+            break;
+        } else if (token == "string" || token == "refutation" || token == "currline") {
+            // Free text / move lists we don't use: nothing of interest follows
+            break;
+        }
+        // Other keywords (seldepth, nps, time, hashfull, wdl, ...) and their
+        // numeric arguments are skipped token by token
+    }
+
+    return true;
+}
+
+StringView parseBestMove(const StringView& line) {
+    Tokenizer tok(line);
+    StringView token;
+    if (!tok.next(token) || token != "bestmove" || !tok.next(token)) {
+        return StringView();
+    }
+    return token;
+}
@@ -0,0 +1,45 @@
+#ifndef UCI_INFO_H
+#define UCI_INFO_H
+
+#include "StringView.h"
+#include <climits>
+
+// Fields of a UCI "info" line. Text fields are views into the line.
+struct UciInfo {
+    int depth;           // 0 if not present
+    int multiPV;         // 0 if not present
+    bool hasScore;
+    int scoreCP;         // Centipawns; mate scores are mapped to +/-10000
+    bool isMate;
+    int mateInN;
+    bool isBound;        // lowerbound/upperbound (fail-high/low, not a final score)
+    long long nodes;     // -1 if not present
+    StringView pvMove;   // First move of the PV
+    StringView pv;       // Whole PV (space-separated moves)
+
+    UciInfo() { clear(); }
+
+    void clear() {
+        depth = 0;
+        multiPV = 0;
+        hasScore = false;
+        scoreCP = 0;
+        isMate = false;
+        mateInN = 0;
+        isBound = false;
+        nodes = -1;
+        pvMove = StringView();
+        pv = StringView();
+    }
+};
+
+// Tokenize a UCI "info" line in a single pass without allocating.
+// Returns false if the line is not an info line or its depth lies outside
+// [minDepth, maxDepth]; in the latter case parsing stops right after the
+// depth token (info.depth is set) so filtered lines cost almost nothing.
+bool parseInfoLine(const StringView& line, UciInfo& info, int minDepth = 0, int maxDepth = INT_MAX);
+
+// Move of a "bestmove <move> [ponder <move>]" line; empty if not a bestmove line
+StringView parseBestMove(const StringView& line);
+
+#endif // UCI_INFO_H